@@ -8,6 +8,7 @@
 #include <execution> // std::execution
 #include <initializer_list> // std::initializer_list
 #include <ranges>
+#include <span> // std::span
 
 #include "arrayiterator.hpp"
 
@@ -395,6 +396,7 @@ public:
 
   //
   constexpr void clear() noexcept { l_ = f_; }
+  constexpr void reset() noexcept { f_ = l_ = a_; } // empty and linearized
   constexpr void resize(size_type const c) noexcept { l_ = next_(f_, c); }
 
   template <int = 0>
@@ -715,6 +717,38 @@ public:
   }
 
   constexpr auto csplit() const noexcept { return split(); }
+
+  // producer/consumer access to the free and the filled region
+  constexpr std::array<std::span<T>, 2> prepare(size_type n) noexcept
+  { // up to n writable slots past the last element, see commit()
+    n = std::min(n, capacity() - size());
+
+    auto const c(std::min(n, size_type(std::addressof(a_[N]) - l_)));
+
+    return {std::span<T>(l_, c), std::span<T>(a_, n - c)};
+  }
+
+  constexpr void commit(size_type const n) noexcept
+  { // publishes n (<= prepared) slots
+    l_ = next_(l_, n);
+  }
+
+  constexpr std::array<std::span<T>, 2> data_spans() noexcept
+  {
+    auto const s(split());
+
+    return {std::span<T>(s[0][0], s[0][1]), std::span<T>(s[1][0], s[1][1])};
+  }
+
+  constexpr std::array<std::span<T const>, 2> data_spans() const noexcept
+  {
+    auto const s(split());
+
+    return {std::span<T const>(s[0][0], s[0][1]),
+      std::span<T const>(s[1][0], s[1][1])};
+  }
+
+  constexpr void consume(size_type const n) noexcept { pop_front(n); }
 };
 
 //////////////////////////////////////////////////////////////////////////////
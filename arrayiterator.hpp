@@ -86,7 +86,10 @@ public:
   }
 
   // conversion to bool
-  constexpr explicit operator bool() const noexcept { return n_ != a_->l_; }
+  constexpr explicit operator bool() const noexcept
+  {
+    return n_ != a_->last();
+  }
 
   // increment, decrement
   constexpr auto& operator++() noexcept { n_ = a_->next_(n_); return *this; }
@@ -105,8 +108,8 @@ public:
   // arithmetic
   constexpr auto operator-(arrayiterator const& o) const noexcept
   {
-    auto const f(a_->f_);
-    return CA::distance_(f, n_) - CA::distance_(f, o.n_);
+    auto const f(a_->first());
+    return a_->distance_(f, n_) - a_->distance_(f, o.n_);
   }
 
   constexpr arrayiterator operator+(difference_type const n) const noexcept
@@ -137,8 +140,8 @@ public:
 
   constexpr auto operator<=>(arrayiterator const& o) const noexcept
   {
-    decltype(n_) const f(a_->f_);
-    return CA::distance_(f, n_) <=> CA::distance_(f, o.n_);
+    auto const f(a_->first());
+    return a_->distance_(f, n_) <=> a_->distance_(f, o.n_);
   }
 
   // member access
@@ -0,0 +1,447 @@
+#ifndef DQ_ASYNC_FLUSHER_HPP
+# define DQ_ASYNC_FLUSHER_HPP
+# pragma once
+
+#include <atomic> // std::atomic_ref
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <linux/io_uring.h> // io_uring_params, io_uring_sqe, io_uring_cqe
+#include <sys/mman.h> // ::mmap()
+#include <sys/syscall.h> // SYS_io_uring_setup, SYS_io_uring_enter
+
+#include "io.hpp"
+
+namespace dq
+{
+
+namespace detail
+{
+
+class uring
+{ // just enough io_uring for the flusher, raw system calls, no liburing
+  int fd_{-1};
+
+  void* sq_{MAP_FAILED}, *cq_{MAP_FAILED}, *sqe_{MAP_FAILED};
+  std::size_t sqn_{}, cqn_{}, sqen_{}; // mapping sizes
+
+  unsigned* st_, *sm_, *sa_; // sq tail, mask, index array
+  unsigned* ch_, *ct_, *cm_; // cq head, tail, mask
+  io_uring_cqe* cqe_;
+
+  unsigned t_{}, p_{}; // local sq tail, entries not yet submitted
+
+  template <typename U>
+  static U* at_(void* const b, unsigned const o) noexcept
+  {
+    return reinterpret_cast<U*>(static_cast<char*>(b) + o);
+  }
+
+  void reset_() noexcept
+  {
+    if (MAP_FAILED != sqe_) ::munmap(sqe_, sqen_);
+    if ((MAP_FAILED != cq_) && (cq_ != sq_)) ::munmap(cq_, cqn_);
+    if (MAP_FAILED != sq_) ::munmap(sq_, sqn_);
+    if (fd_ >= 0) ::close(fd_);
+
+    fd_ = -1; sq_ = cq_ = sqe_ = MAP_FAILED;
+  }
+
+public:
+  explicit uring(unsigned const n) noexcept
+  { // room for n entries in flight, check operator bool
+    io_uring_params p{};
+
+    if ((fd_ = int(::syscall(SYS_io_uring_setup, n, &p))) < 0)
+      return;
+    else if (!(p.features & IORING_FEAT_RW_CUR_POS)) // off -1 needs it
+    {
+      reset_(); return;
+    }
+
+    bool const single(p.features & IORING_FEAT_SINGLE_MMAP);
+
+    sqn_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cqn_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    sqen_ = p.sq_entries * sizeof(io_uring_sqe);
+
+    if (single) sqn_ = cqn_ = std::max(sqn_, cqn_);
+
+    auto const map([&](std::size_t const sz, off_t const o) noexcept
+      {
+        return ::mmap({}, sz, PROT_READ | PROT_WRITE,
+          MAP_SHARED | MAP_POPULATE, fd_, o);
+      }
+    );
+
+    if ((MAP_FAILED == (sq_ = map(sqn_, IORING_OFF_SQ_RING))) ||
+      (MAP_FAILED == (cq_ = single ? sq_ : map(cqn_, IORING_OFF_CQ_RING))) ||
+      (MAP_FAILED == (sqe_ = map(sqen_, IORING_OFF_SQES))))
+    {
+      reset_(); return;
+    }
+
+    st_ = at_<unsigned>(sq_, p.sq_off.tail);
+    sm_ = at_<unsigned>(sq_, p.sq_off.ring_mask);
+    sa_ = at_<unsigned>(sq_, p.sq_off.array);
+
+    ch_ = at_<unsigned>(cq_, p.cq_off.head);
+    ct_ = at_<unsigned>(cq_, p.cq_off.tail);
+    cm_ = at_<unsigned>(cq_, p.cq_off.ring_mask);
+    cqe_ = at_<io_uring_cqe>(cq_, p.cq_off.cqes);
+
+    t_ = *st_;
+  }
+
+  uring(uring const&) = delete;
+  uring& operator=(uring const&) = delete;
+
+  ~uring() { reset_(); }
+
+  //
+  explicit operator bool() const noexcept { return fd_ >= 0; }
+
+  io_uring_sqe& sqe() noexcept
+  { // the next zeroed entry, at most n are in flight
+    auto const i(t_++ & *sm_);
+
+    ++p_; sa_[i] = i;
+
+    return static_cast<io_uring_sqe*>(sqe_)[i] = {};
+  }
+
+  int enter(unsigned const wait) noexcept
+  { // submits the queued entries, waits for wait completions, -errno
+    std::atomic_ref(*st_).store(t_, std::memory_order_release);
+
+    auto const r(::syscall(SYS_io_uring_enter, fd_, p_, wait,
+      IORING_ENTER_GETEVENTS, nullptr, 0));
+
+    return r < 0 ? -errno : (p_ -= unsigned(r), 0);
+  }
+
+  bool reap(io_uring_cqe& c) noexcept
+  {
+    auto const h(*ch_);
+
+    if (h == std::atomic_ref(*ct_).load(std::memory_order_acquire))
+      return false;
+
+    c = cqe_[h & *cm_];
+    std::atomic_ref(*ch_).store(h + 1, std::memory_order_release);
+
+    return true;
+  }
+};
+
+}
+
+template <typename Ring, std::size_t K = 1>
+requires(std::is_trivially_copyable_v<typename Ring::value_type> && (K > 0))
+class async_flusher
+{ // drains rings to fds on a background thread, producers never write();
+  // the thread submits linked io_uring writes, or writev()s when io_uring
+  // is not available at run time
+public:
+  using value_type = typename Ring::value_type;
+  using size_type = std::size_t;
+
+//private:
+  using span_type = std::span<value_type const>;
+
+  std::array<Ring*, K> r_;
+  std::array<int, K> fd_;
+
+  size_type const hw_; // producers wait above this fill level
+  bool const sync_; // fdatasync() after every batch
+
+  std::mutex m_;
+  std::condition_variable cf_, cp_; // flusher, producers
+
+  int e_{}; // errno of the first failed write
+  bool stop_{};
+
+  enum : std::uint64_t { FSYNC = std::uint64_t(1) << 63 }; // user_data tag
+
+  detail::uring u_{2 * K}; // a write and a linked fdatasync() per ring
+  iovec v_[K][2]; // in flight
+
+  std::thread t_;
+
+  bool idle_() const noexcept
+  {
+    return std::ranges::all_of(r_, [](auto const r) noexcept
+      { return r->empty(); });
+  }
+
+  size_type drain_(int const fd, std::array<span_type, 2> const& s,
+    size_type const n) noexcept
+  { // one writev() per ring and batch, returns elements written
+    iovec v[2];
+
+    if (auto const c(detail::iovecs(v, s, n)); !c)
+      return 0;
+    else if (auto const r(::writev(fd, v, c)); r > 0)
+    {
+      auto const b(detail::complete<value_type>(
+        [](int const fd, void const* const p, std::size_t const k) noexcept
+        {
+          return ::write(fd, p, k);
+        }, fd, POLLOUT, v, r));
+
+      if (b % sizeof(value_type)) // torn, its head is already on fd
+      {
+        std::lock_guard l(m_); if (!e_) e_ = errno;
+      }
+
+      return (b + sizeof(value_type) - 1) / sizeof(value_type);
+    }
+    else if (!r || (EINTR == errno) || (EAGAIN == errno))
+      return 0;
+    else
+    {
+      std::lock_guard l(m_); if (!e_) e_ = errno; return 0;
+    }
+  }
+
+  void fail_(int const e) noexcept
+  {
+    std::lock_guard l(m_); if (!e_) e_ = e;
+  }
+
+  bool pop_(size_type const i, size_type const n)
+  {
+    if (n)
+    {
+      { std::lock_guard l(m_); r_[i]->pop_front(n); }
+
+      cp_.notify_all();
+    }
+
+    return n;
+  }
+
+  bool writev_pass_(std::unique_lock<std::mutex>& l)
+  { // one writev() per ring, returns true on progress
+    std::array<std::array<span_type, 2>, K> s;
+    std::array<size_type, K> n;
+
+    for (size_type i{}; i != K; ++i) // snapshot under the lock
+      s[i] = std::as_const(*r_[i]).data_spans(), n[i] = r_[i]->size();
+
+    l.unlock();
+
+    for (size_type i{}; i != K; ++i)
+      if (n[i])
+      {
+        n[i] = drain_(fd_[i], s[i], n[i]);
+        if (sync_ && n[i]) ::fdatasync(fd_[i]);
+      }
+
+    l.lock();
+
+    for (size_type i{}; i != K; ++i) r_[i]->pop_front(n[i]);
+
+    return std::ranges::any_of(n, [](auto const k) noexcept { return k; }) &&
+      (cp_.notify_all(), true);
+  }
+
+  size_type written_(size_type const i, int const r) noexcept
+  { // elements covered by a write completion of r bytes
+    if (r > 0)
+    {
+      auto const b(detail::complete<value_type>(
+        [](int const fd, void const* const p, std::size_t const k) noexcept
+        {
+          return ::write(fd, p, k);
+        }, fd_[i], POLLOUT, v_[i], r));
+
+      if (b % sizeof(value_type)) fail_(errno); // torn, its head is on fd
+
+      return (b + sizeof(value_type) - 1) / sizeof(value_type);
+    }
+    else if (r && (-EAGAIN != r) && (-EINTR != r))
+      fail_(-r);
+
+    return 0;
+  }
+
+  bool uring_pass_(std::unique_lock<std::mutex>& l)
+  { // one batch of writes, each ring is popped as its completion arrives
+    std::array<size_type, K> w{}; // elements written, awaiting fdatasync()
+    unsigned q{}; // completions outstanding
+
+    for (size_type i{}; i != K; ++i) // prepared under the lock
+      if (auto const n(r_[i]->size()); n)
+      {
+        auto& e(u_.sqe());
+
+        e.opcode = IORING_OP_WRITEV;
+        e.fd = fd_[i];
+        e.off = std::uint64_t(-1); // the current file position
+        e.addr = reinterpret_cast<std::uintptr_t>(v_[i]);
+        e.len = detail::iovecs(v_[i], std::as_const(*r_[i]).data_spans(), n);
+        e.user_data = i;
+        ++q;
+
+        if (sync_)
+        { // cancelled if the write fails or comes up short
+          e.flags = IOSQE_IO_LINK;
+
+          auto& f(u_.sqe());
+
+          f.opcode = IORING_OP_FSYNC;
+          f.fd = fd_[i];
+          f.fsync_flags = IORING_FSYNC_DATASYNC;
+          f.user_data = i | FSYNC;
+          ++q;
+        }
+      }
+
+    l.unlock();
+
+    bool p{};
+
+    for (io_uring_cqe c; q;)
+      if (auto const e(u_.enter(1)); e && (-EINTR != e))
+      {
+        fail_(-e); break;
+      }
+      else
+        for (; u_.reap(c); --q)
+          if (auto const i(size_type(c.user_data & ~FSYNC));
+            c.user_data & FSYNC)
+          {
+            if ((-ECANCELED == c.res) && w[i]) ::fdatasync(fd_[i]);
+
+            p |= pop_(i, w[i]);
+          }
+          else if (w[i] = written_(i, c.res); !sync_)
+            p |= pop_(i, w[i]);
+
+    l.lock();
+
+    return p;
+  }
+
+  void run_()
+  {
+    std::chrono::milliseconds b{}; // backoff after a pass without progress
+
+    std::unique_lock l(m_);
+
+    for (;;)
+    {
+      cf_.wait(l, [&]() noexcept { return stop_ || e_ || !idle_(); });
+
+      if (e_ || idle_()) break; // stopped and drained, or failed
+
+      if (u_ ? uring_pass_(l) : writev_pass_(l))
+        b = {};
+      else if (!e_) // EAGAIN, EINTR or a 0 byte write, do not spin
+        b = std::clamp(2 * b, std::chrono::milliseconds(1),
+          std::chrono::milliseconds(64)), cf_.wait_for(l, b);
+    }
+
+    stop_ = true; l.unlock(); cp_.notify_all();
+  }
+
+public:
+  explicit async_flusher(std::array<Ring*, K> const& r,
+    std::array<int, K> const& fd, size_type const high = Ring::capacity(),
+    bool const sync = false):
+    r_(r),
+    fd_(fd),
+    hw_(std::clamp(high, size_type(1), Ring::capacity())),
+    sync_(sync),
+    t_(&async_flusher::run_, this)
+  {
+  }
+
+  async_flusher(Ring& r, int const fd, size_type const high =
+    Ring::capacity(), bool const sync = false) requires(1 == K):
+    async_flusher({&r}, {fd}, high, sync)
+  {
+  }
+
+  async_flusher(async_flusher const&) = delete;
+  async_flusher& operator=(async_flusher const&) = delete;
+
+  ~async_flusher() { stop(); }
+
+  //
+  bool uring() const noexcept { return bool(u_); }
+  int error() noexcept { std::lock_guard l(m_); return e_; }
+
+  size_type write(size_type const i, value_type const* p, size_type n)
+  { // blocks while ring i is above the high water mark, returns the
+    // number of elements queued, less than n only on error or stop()
+    size_type r{};
+
+    for (std::unique_lock l(m_); n;)
+    {
+      auto& a(*r_[i]);
+
+      cp_.wait(l, [&]() noexcept { return stop_ || (a.size() < hw_); });
+
+      if (stop_) break;
+
+      auto const e(a.empty());
+      auto const k(a.append(p, std::min(n, hw_ - a.size())));
+
+      p += k; n -= k; r += k;
+
+      if (e) cf_.notify_one(); // the flusher only sleeps on empty rings
+    }
+
+    return r;
+  }
+
+  size_type write(value_type const* const p, size_type const n)
+    requires(1 == K)
+  {
+    return write(0, p, n);
+  }
+
+  size_type try_write(size_type const i, value_type const* const p,
+    size_type const n)
+  { // never blocks, returns the number of elements queued
+    std::lock_guard l(m_);
+
+    if (auto& a(*r_[i]); stop_ || (a.size() >= hw_))
+      return 0;
+    else
+    {
+      auto const e(a.empty());
+      auto const k(a.append(p, std::min(n, hw_ - a.size())));
+
+      if (e && k) cf_.notify_one();
+
+      return k;
+    }
+  }
+
+  void flush()
+  { // waits until every ring is drained
+    std::unique_lock l(m_);
+    cp_.wait(l, [&]() noexcept { return stop_ || idle_(); });
+  }
+
+  void stop()
+  { // drains what is queued, then joins the flusher
+    if (t_.joinable())
+    {
+      { std::lock_guard l(m_); stop_ = true; }
+
+      cf_.notify_one(); cp_.notify_all();
+
+      t_.join();
+    }
+  }
+};
+
+}
+
+#endif // DQ_ASYNC_FLUSHER_HPP
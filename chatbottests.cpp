@@ -1,11 +1,40 @@
 #include <cassert>
+#include <deque>
 #include <iostream>
 #include <memory>
+#include <numeric>
 #include <random>
 #include <thread>
 #include <vector>
 
+#include <fcntl.h>
+#include <sys/wait.h>
+
 #include "array.hpp" // Replace with the actual container header
+#include "async_flusher.hpp"
+#include "circular_arena.hpp"
+#include "disruptor.hpp"
+#include "fir.hpp"
+#include "frame.hpp"
+#include "io.hpp"
+#include "journal.hpp"
+#include "lru.hpp"
+#include "merge_rings.hpp"
+#include "recent_set.hpp"
+#include "record_ring.hpp"
+#include "seq_array.hpp"
+#include "seqlock_ring.hpp"
+#include "sharded_ring.hpp"
+#include "shm_ring.hpp"
+#include "spsc_ring.hpp"
+#include "ring2d.hpp"
+#include "ring_view.hpp"
+#include "rolling_hash.hpp"
+#include "thread_pool.hpp"
+#include "time_ring.hpp"
+#include "timer_wheel.hpp"
+#include "window_topk.hpp"
+#include "ws_deque.hpp"
 
 // Include your testing framework of choice (e.g., Google Test or Catch2)
 
@@ -1643,6 +1672,1228 @@ void test1() {
     assert(*std::next(dq.rbegin(), 2) == 50);
     assert(*std::prev(dq.rend(), 3)   == 30);
   }
+
+  { // test_window_topk
+    dq::window_topk<int, 64, 3> w;
+    dq::window_cms<int, 64, 3> s;
+    std::mt19937 g(7);
+
+    for (int i{}; i != 2000; ++i)
+    {
+      int const k(g() % 11 ? g() % 5 : g() % 50);
+      w.push(k); s.push(k);
+
+      for (auto&& e: w.topk())
+        assert(e.count == std::size_t(std::ranges::count(w.window(), e.key)));
+
+      for (int j{}; j != 50; ++j)
+      {
+        auto const c(std::size_t(std::ranges::count(w.window(), j)));
+        assert(w.count(j) == c);
+        assert(s.count(j) >= c);
+      }
+
+      for (int j{}; j != 50; ++j)
+        if (std::ranges::find(w.topk(), j, &decltype(w)::entry::key) ==
+          w.topk().end())
+          assert(w.count(j) <= w.topk().back().count);
+    }
+
+    assert(w.size() == 64 && w.topk().size() == 3);
+    assert(std::ranges::is_sorted(w.topk(), std::greater<>(),
+      &decltype(w)::entry::count));
+    assert(s.topk().front().count >= w.topk().front().count);
+  }
+
+  { // test_fir
+    dq::fir<int, 4> f{1, 2, 3, 4};
+    dq::fir<int, 4, 16> g{1, 2, 3, 4};
+    int x[100], y[100];
+
+    std::iota(std::begin(x), std::end(x), 1);
+    g.process(x, y, 37); g.process(x + 37, y + 37, 63);
+
+    for (int n{}; n != 100; ++n)
+    {
+      int r{};
+      for (int k{}; k != 4; ++k) r += n >= k ? (k + 1) * x[n - k] : 0;
+
+      assert(f(x[n]) == r);
+      assert(y[n] == r);
+    }
+
+    assert(std::ranges::equal(f.delay_line(), g.delay_line()));
+  }
+
+  { // test_rolling_hash
+    dq::rolling_hash<std::byte, 300> h, g;
+    std::byte b[2000];
+    std::mt19937 r(3);
+
+    std::ranges::generate(b, [&]{ return std::byte(r()); });
+
+    for (std::size_t i{}; i != std::size(b); ++i)
+    {
+      h.push_back(b[i]);
+      auto const n(std::min(i + 1, h.capacity()));
+      assert(h.hash() == h.hash_of(b + i + 1 - n, n));
+    }
+
+    for (std::size_t i{}, c{}; i != std::size(b); i += c)
+    {
+      g.append(b + i, c = std::min(r() % 400, std::size(b) - i));
+      auto const n(std::min(i + c, g.capacity()));
+      assert(g.hash() == g.hash_of(b + i + c - n, n));
+    }
+
+    assert(g.hash() == h.hash() && (g.window() == h.window()));
+
+    h.pop_front();
+    assert(h.hash() == h.hash_of(std::end(b) - 299, 299));
+  }
+
+  { // test_rolling_hash_mixed, pops keep the cached power in step
+    dq::rolling_hash<std::uint16_t, 40> h;
+    std::deque<std::uint16_t> v; // reference window
+    std::mt19937 r(37);
+
+    for (int i{}; i != 5000; ++i)
+    {
+      if (auto const k(r() % 8); !k && !v.empty())
+        h.pop_front(), v.pop_front();
+      else if (1 == k)
+      {
+        std::uint16_t a[60];
+        auto const c(r() % 60);
+
+        std::ranges::generate_n(a, c, [&]{ return std::uint16_t(r()); });
+        h.append(a, c); v.insert(v.end(), a, a + c);
+      }
+      else
+        v.push_back(std::uint16_t(r())), h.push_back(v.back());
+
+      while (v.size() > 40) v.pop_front();
+
+      std::vector<std::uint16_t> const w(v.begin(), v.end());
+      assert(h.hash() == h.hash_of(w.data(), w.size()));
+    }
+  }
+
+  { // test_recent_set
+    dq::recent_set<int, 50> s;
+    std::vector<int> v; // reference, the last 50 accepted keys
+    std::mt19937 r(5);
+
+    for (int i{}; i != 5000; ++i)
+    {
+      int const k(r() % 120);
+      bool const seen(std::ranges::find(v, k) != v.end());
+
+      assert(s.insert(k) == !seen);
+      if (!seen && (v.push_back(k), v.size() > 50)) v.erase(v.begin());
+
+      assert(s.contains(k) && (s.size() == v.size()));
+    }
+
+    for (int k{}; k != 120; ++k)
+      assert(s.contains(k) == (std::ranges::find(v, k) != v.end()));
+  }
+
+  { // test_recent_set_copy, the ring has wrapped
+    dq::recent_set<int, 4> s;
+
+    for (int i{}; i != 6; ++i) s.insert(i);
+
+    auto c(s);
+    assert(c.contains(5) && c.contains(2) && !c.contains(1));
+    assert(!c.insert(5) && c.insert(6) && !c.contains(2));
+
+    auto m(std::move(s));
+    assert(m.contains(5) && m.contains(2) && !m.contains(1));
+
+    s = c;
+    assert(s.contains(6) && s.contains(3) && !s.contains(2));
+
+    c = std::move(m);
+    assert(c.contains(5) && !c.contains(6));
+  }
+
+  { // test_lru
+    dq::lru<int, int, 16> c;
+    std::vector<std::pair<int, int>> v; // reference, most recent last
+    std::mt19937 r(11);
+
+    auto const find([&](int const k)
+      {
+        return std::ranges::find(v, k, &std::pair<int, int>::first);
+      }
+    );
+
+    for (int i{}; i != 20000; ++i)
+    {
+      int const k(r() % 40);
+
+      switch (r() % 4)
+      {
+        case 0:
+          if (auto const j(find(k)); j != v.end())
+          {
+            auto const e(*j);
+            v.erase(j); v.push_back(e);
+            assert(*c.get(k) == e.second);
+          }
+          else
+            assert(!c.get(k));
+          break;
+
+        case 1:
+          assert(c.erase(k) == (find(k) != v.end()));
+          if (auto const j(find(k)); j != v.end()) v.erase(j);
+          break;
+
+        default:
+          if (auto const j(find(k)); j != v.end()) v.erase(j);
+          else if (v.size() == 16) v.erase(v.begin());
+          v.emplace_back(k, i);
+          assert(c.put(k, i) == i);
+      }
+
+      assert(c.size() == v.size());
+    }
+
+    for (int k{}; k != 40; ++k)
+      assert(c.peek(k) ? *c.peek(k) == find(k)->second : find(k) == v.end());
+
+    dq::lru<int, std::string, 2, dq::NEW> s;
+    s.put(1, "a"); s.put(2, "b"); s.get(1); s.put(3, "c");
+    assert(s.contains(1) && !s.contains(2) && (*s.get(3) == "c"));
+  }
+
+  { // test_lru_stamps, 2^32 touches must not revive a stale record
+    dq::lru<int, int, 4> c;
+
+    for (int k(1); k != 5; ++k) c.put(k, k);
+    c.get(1); // the first record of 1 is stale now
+
+    c.t_ = UINT32_MAX; c.get(2); c.get(1);
+    c.put(5, 5); // evicts 3, the least recently used
+
+    assert(c.contains(1) && c.contains(2) && !c.contains(3));
+  }
+
+  { // test_time_ring
+    struct rec { int t, v; };
+    using tr_t = dq::time_ring<rec, 32,
+      decltype([](rec const& r) noexcept { return r.t; })>;
+
+    tr_t tr;
+    std::vector<rec> v;
+    std::mt19937 r(13);
+
+    auto const flat([](auto const& s)
+      {
+        std::vector<int> o;
+        for (auto&& p: s) for (auto&& e: p) o.push_back(e.v);
+        return o;
+      }
+    );
+
+    for (int i{}, t{}; i != 3000; ++i)
+    {
+      t += r() % 3;
+      tr.push_back(rec{t, i}); v.push_back({t, i});
+      if (v.size() > 32) v.erase(v.begin());
+
+      int const t0(t - int(r() % 20)), t1(t0 + int(r() % 10));
+      std::vector<int> e;
+      for (auto&& x: v) if ((x.t >= t0) && (x.t < t1)) e.push_back(x.v);
+      assert(flat(tr.range(t0, t1)) == e);
+
+      if (!(i % 7))
+      {
+        auto const n(std::ranges::count_if(v, [&](auto& x){ return x.t < t0; }));
+        assert(tr.evict_older_than(t0) == std::size_t(n));
+        v.erase(v.begin(), v.begin() + n);
+      }
+
+      assert(tr.size() == v.size());
+    }
+  }
+
+  { // test_merge_rings
+    using ring_t = dq::array<int, 64>;
+    ring_t a[5];
+    dq::merge_rings<ring_t, 5> m;
+    std::mt19937 r(17);
+    std::vector<int> o, e;
+
+    for (auto& x: a) m.add(x);
+
+    for (int i{}; i != 200; ++i)
+    {
+      for (int j{}; j != 5; ++j)
+        for (auto n(r() % 8); n && !a[j].full(); --n)
+          a[j].push_back((a[j].empty() ? i : a[j].back()) + int(r() % 4));
+
+      auto const s(o.size());
+      m.merge([&](int const v) { o.push_back(v); }, r() % 50);
+
+      assert(std::ranges::is_sorted(o.begin() + s, o.end()));
+      for (auto& x: a) assert(x.empty() || (o.size() == s) || (o.back() <= x.front()));
+    }
+
+    dq::array<int, 1000> out;
+    e.assign(o.begin(), o.end());
+    for (auto& x: a) e.insert(e.end(), x.begin(), x.end());
+
+    auto const s(out.size());
+    m.drain(out);
+    assert(std::ranges::all_of(a, &ring_t::empty) && std::ranges::is_sorted(out));
+    o.insert(o.end(), out.begin() + s, out.end());
+    std::ranges::sort(e); std::ranges::sort(o);
+    assert(o == e);
+  }
+
+  { // test_merge_rings_bounded, a full output ring is not overwritten
+    dq::array<int, 8> a{1, 3, 5, 7, 9}, b{2, 4, 6, 8, 10};
+    dq::merge_rings<dq::array<int, 8>, 2> m{&a, &b};
+    dq::array<int, 4> out{0};
+
+    assert((m.drain(out) == 3) && (out == dq::array<int, 4>{0, 1, 2, 3}));
+    assert((a.size() == 3) && (b.size() == 4));
+
+    out.clear();
+    assert((m.drain(out) == 4) && (out == dq::array<int, 4>{4, 5, 6, 7}));
+    assert(!m.drain(out) && (a.size() + b.size() == 3));
+
+    dq::sharded_ring<int, 8, 2> sr;
+    auto w(sr.acquire());
+
+    for (int i{}; i != 6; ++i) w.push(i);
+    out.clear();
+    assert((sr.drain(out) == 4) && (sr.size() == 2));
+  }
+
+  { // test_ring2d
+    dq::ring2d<int, 5, 3> g;
+
+    for (int i{}; i != 23; ++i)
+    {
+      if (i % 2)
+        std::ranges::fill(g.prepare_row(), i), g.commit_row();
+      else
+        g.push_row(std::array{i, i, i});
+
+      auto const k(std::min<std::size_t>(3, g.size()));
+      std::vector<int> w;
+      for (auto&& s: g.window(k)) w.insert(w.end(), s.begin(), s.end());
+
+      assert(w.size() == 3 * k);
+      for (std::size_t j{}; j != w.size(); ++j)
+        assert(w[j] == i + 1 - int(k) + int(j / 3));
+
+      assert((g.back()[2] == i) && (g(0, 1) == g.row(0)[1]));
+    }
+
+    assert(g.full() && (g.row(0)[0] == 18));
+  }
+
+  { // test_timer_wheel
+    dq::timer_wheel<int, 512, 64, 8, 3> tw; // 8^3 ticks before clamping
+    std::vector<std::pair<std::uint64_t, int>> v; // reference, deadline/id
+    std::vector<decltype(tw)::handle> h(2000, decltype(tw)::invalid);
+    std::mt19937 r(19);
+
+    for (int i{}; i != 2000; ++i)
+    {
+      auto const d(tw.now() + 1 + r() % (r() % 4 ? 60 : 3000));
+
+      if ((h[i] = tw.schedule(d, i)).i != decltype(tw)::invalid.i)
+        v.emplace_back(d, i);
+
+      if (int const j(r() % (i + 1)); !(r() % 5) && tw.cancel(h[j]))
+      {
+        assert(std::erase_if(v, [&](auto& e){ return e.second == j; }) == 1);
+        assert(!tw.cancel(h[j]));
+      }
+
+      tw.advance(tw.now() + r() % 3, [&](int const id)
+        {
+          auto const k(std::ranges::find(v, id, &decltype(v)::value_type::second));
+          assert((k != v.end()) && (k->first == tw.now()));
+          v.erase(k);
+        }
+      );
+
+      assert(tw.size() == v.size());
+    }
+
+    tw.advance(tw.now() + 5000, [&](int) {});
+    assert(tw.empty());
+  }
+
+  { // test_timer_wheel_full_bucket
+    dq::timer_wheel<int, 8, 2, 4, 2> tw; // 2 timers per bucket, 16 ticks
+    std::vector<std::pair<std::uint64_t, int>> f; // fired, tick/id
+
+    auto const fire([&](int const id) { f.emplace_back(tw.now(), id); });
+
+    tw.schedule(5, 0); tw.schedule(5, 1); // level 1
+    tw.advance(2, fire);
+
+    tw.schedule(5, 2); tw.schedule(5, 3); // fills the level 0 bucket
+    assert(tw.schedule(5, 4).i == decltype(tw)::invalid.i);
+
+    tw.advance(5, fire); // 0 and 1 could not cascade on tick 4
+    assert((f == decltype(f){{5, 2}, {5, 3}}) && (tw.size() == 2));
+
+    tw.advance(6, fire); // postponed to the next tick with room
+    assert((f.size() == 4) && (f[2].first == 6) && (f[3].first == 6));
+    assert(tw.empty());
+  }
+
+  { // test_timer_wheel_full_bucket_levels, 64 slots, 4 levels
+    dq::timer_wheel<int, 16, 2> tw;
+    std::vector<std::pair<std::uint64_t, int>> f; // fired, tick/id
+
+    auto const fire([&](int const id) { f.emplace_back(tw.now(), id); });
+
+    tw.schedule(5000, 0); tw.schedule(5000, 1); // level 2
+    tw.advance(1000, fire);
+
+    tw.schedule(5000, 2); tw.schedule(5001, 3); // fills a level 1 bucket
+
+    tw.advance(5000 + 63, fire); // 0 and 1 are late by less than SLOTS
+    assert((f.size() == 4) && (f[0].first == 5000) && (f[0].second == 2));
+    assert((f[1].first == 5001) && (f[2].first > 5001) && tw.empty());
+  }
+
+  { // test_record_ring
+    dq::record_ring<100> rr;
+    std::vector<std::vector<std::byte>> v; // reference, oldest first
+    std::mt19937 r(23);
+
+    for (int i{}; i != 20000; ++i)
+    {
+      if (r() % 2)
+      {
+        std::vector<std::byte> e(r() % 40, std::byte(i));
+
+        if (auto const s(rr.reserve(e.size())); s.data())
+        {
+          std::ranges::copy(e, s.begin());
+          if (r() % 2) rr.commit(); else e.resize(e.size() / 2), rr.commit(e.size());
+          v.push_back(e);
+        }
+        else
+          assert(!v.empty());
+      }
+      else if (!v.empty())
+      {
+        auto const p(rr.peek());
+        assert(std::ranges::equal(p, v.front()));
+        rr.consume(); v.erase(v.begin());
+      }
+
+      assert(rr.empty() == v.empty() && (!rr.empty() || !rr.peek().data()));
+    }
+
+    assert(!rr.push(std::vector<std::byte>(rr.max_record() + 1)));
+  }
+
+  { // test_circular_arena
+    dq::circular_arena<1024> a;
+    std::vector<std::tuple<unsigned char*, std::size_t, std::size_t, int>> v;
+    std::mt19937 r(29);
+
+    for (int i{}; i != 20000; ++i)
+    {
+      if (v.size() < 20 && r() % 2)
+      {
+        std::size_t const n(r() % 100), al(std::size_t(1) << r() % 7);
+        auto const p(static_cast<unsigned char*>(a.allocate(n, al)));
+
+        assert(!(reinterpret_cast<std::uintptr_t>(p) % al));
+        std::fill_n(p, n, (unsigned char)(i));
+        v.emplace_back(p, n, al, i);
+      }
+      else if (!v.empty())
+      { // mostly FIFO, sometimes out of order
+        auto const j(r() % 4 ? 0 : r() % v.size());
+        auto const [p, n, al, k](v[j]);
+
+        assert(std::all_of(p, p + n, [&](auto c){ return c == (unsigned char)(k); }));
+        a.deallocate(p, n, al);
+        v.erase(v.begin() + j);
+      }
+    }
+
+    for (auto [p, n, al, k]: v) a.deallocate(p, n, al);
+    assert(a.empty());
+
+    dq::arena_resource<decltype(a)> m(a);
+    std::pmr::vector<int> pv(&m);
+    for (int i{}; i != 100; ++i) pv.push_back(i);
+    assert(pv[99] == 99);
+  }
+
+  { // test_frame
+    dq::array<char, 16> c;
+    std::string_view const in("GET /\r\nHost: a\r\n\r\nabcdefghijklmnop\nxyz");
+    std::vector<std::string> o;
+
+    for (auto p(in.data()); p != in.data() + in.size();)
+    {
+      auto const n(c.append(p,
+        std::min<std::size_t>(5, in.data() + in.size() - p)));
+
+      p += n;
+
+      while (auto const f = dq::next_line(c))
+      {
+        o.emplace_back(f.parts[0]).append(f.parts[1]);
+        dq::consume(c, f);
+      }
+
+      if (!n && c.full()) break; // a frame longer than the ring
+    }
+
+    assert((o == std::vector<std::string>{"GET /", "Host: a", ""}));
+    assert(!dq::find_delimiter(c, '\n') && (c.size() == 16)); // full, no frame
+
+    dq::array<std::byte, 8> b;
+    b.push_back(std::byte{1}, std::byte{2}, std::byte{0});
+    auto const f(dq::find_delimiter(b, std::byte{0}));
+    assert((f.consumed == 3) && (f.size() == 2) && (f.parts[0][1] == std::byte{2}));
+  }
+
+  { // test_prepare_commit
+    dq::array<int, 10> c{1, 2, 3, 4, 5, 6, 7};
+    c.pop_front(5); // [6, 7], the free region wraps
+
+    auto const p(c.prepare(100));
+    assert(p[0].size() + p[1].size() == 8);
+
+    int i(8);
+    for (auto&& s: p) for (auto& e: s) e = i++;
+    c.commit(5);
+
+    assert((c == dq::array<int, 10>{6, 7, 8, 9, 10, 11, 12}));
+
+    std::vector<int> v;
+    for (auto&& s: c.data_spans()) v.insert(v.end(), s.begin(), s.end());
+    assert(std::ranges::equal(v, c));
+
+    c.consume(3);
+    assert((c.front() == 9) && (std::as_const(c).data_spans()[0].front() == 9));
+    assert(c.prepare(3)[0].size() + c.prepare(3)[1].size() == 3);
+  }
+
+  { // test_seq_array
+    dq::seq_array<int, 8> s;
+    auto c(s.oldest()), d(s.oldest());
+
+    for (int i{}; i != 5; ++i) s.push_back(i);
+    assert((*s.next(c) == 0) && (*s.next(c) == 1));
+
+    for (int i(5); i != 20; ++i) s.push_back(i); // 12..19 remain
+    assert((s.front_seq() == 12) && (s.end_seq() == 20));
+    assert((s.seq_of(s.front()) == 12) && (s.seq_of(s.back()) == 19));
+    assert((*s.at_seq(15) == 15) && !s.at_seq(11) && !s.at_seq(20));
+
+    assert((s.overrun(c) == 10) && (s.lag(c) == 18));
+    assert((*s.next(c) == 12) && (c.lost == 10));
+
+    auto const r(s.read(d, 5));
+    std::vector<int> v;
+    for (auto&& p: r) v.insert(v.end(), p.begin(), p.end());
+    assert((v == std::vector<int>{12, 13, 14, 15, 16}) && (d.lost == 12));
+
+    s.pop_front(2);
+    assert((s.front() == 14) && (s.front_seq() == 14) && (s.lag(d) == 3));
+
+    s.clear();
+    assert((s.front_seq() == 20) && !s.next(c) && (c.lost == 17));
+  }
+
+  { // test_io
+    int fd[2];
+    assert(!::pipe(fd));
+
+    dq::array<int, 10> a{1, 2, 3, 4, 5, 6, 7, 8}, b;
+    a.pop_front(6); a.push_back(9, 10, 11, 12, 13); // wrapped
+
+    assert(dq::write_to(a, fd[1], 4) == 4);
+    assert(dq::write_to(a, fd[1]) == 3 && a.empty() && !dq::write_to(a, fd[1]));
+
+    b.push_back(0, 0, 0, 0, 0, 0, 0); b.pop_front(7); // wrap b as well
+    assert(dq::read_from(b, fd[0], 2) == 2);
+    assert(dq::read_from(b, fd[0]) == 5);
+    assert((b == dq::array<int, 10>{7, 8, 9, 10, 11, 12, 13}));
+
+    ::close(fd[1]);
+    assert(!dq::read_from(b, fd[0]));
+    ::close(fd[0]);
+  }
+
+  { // test_io_nonblocking, elements straddle the pipe buffer
+    struct e { std::uint32_t x[3]; };
+
+    int fd[2];
+    assert(!::pipe2(fd, O_NONBLOCK));
+    ::fcntl(fd[1], F_SETPIPE_SZ, 4096);
+
+    std::thread t([&]{
+      dq::array<e, 1000> a;
+
+      for (std::uint32_t i{}; i != 20000;)
+      {
+        for (; (i != 20000) && !a.full(); ++i) a.push_back(e{{i, i, i}});
+
+        if (dq::write_to(a, fd[1]) < 0) assert(EAGAIN == errno);
+      }
+
+      while (!a.empty())
+        if (dq::write_to(a, fd[1]) < 0) assert(EAGAIN == errno);
+
+      ::close(fd[1]);
+    });
+
+    dq::array<e, 700> b;
+    std::uint32_t n{};
+
+    for (std::ptrdiff_t r; (r = dq::read_from(b, fd[0]));)
+      if (r < 0)
+      {
+        assert(EAGAIN == errno);
+        pollfd p{fd[0], POLLIN, {}}; ::poll(&p, 1, -1);
+      }
+      else
+        for (; !b.empty(); b.pop_front(), ++n)
+          assert((b.front().x[0] == n) && (b.front().x[2] == n));
+
+    t.join();
+    assert(20000 == n);
+    ::close(fd[0]);
+
+    assert(!::pipe(fd));
+    assert(6 == ::write(fd[1], "\1\0\0\0\2\0", 6)); ::close(fd[1]);
+
+    dq::array<int, 4> c; // the stream ends mid-element
+    assert((dq::read_from(c, fd[0]) < 0) && (EIO == errno));
+    assert((c.size() == 1) && (c.front() == 1));
+    ::close(fd[0]);
+  }
+
+  { // test_async_flusher
+    using ring_t = dq::array<int, 64>;
+
+    ring_t r0, r1;
+    std::FILE* const f[]{std::tmpfile(), std::tmpfile()};
+    int const fd[]{fileno(f[0]), fileno(f[1])};
+
+    {
+      dq::async_flusher<ring_t, 2> af({&r0, &r1}, {fd[0], fd[1]}, 48);
+
+      std::thread t([&]{
+        int b[100];
+        for (int i{}; i != 100; ++i)
+        {
+          std::iota(std::begin(b), std::end(b), i * 100);
+          assert(af.write(1, b, 100) == 100);
+        }
+      });
+
+      for (int i{}; i != 10000; ++i) assert(af.write(0, &i, 1) == 1);
+
+      t.join();
+      af.flush();
+      assert(r0.empty() && r1.empty() && !af.error());
+
+      auto const k(af.try_write(0, std::array{1, 2, 3}.data(), 3));
+      assert(k == 3);
+    }
+
+    assert(r0.empty()); // stop() drains
+
+    for (auto const d: fd)
+    {
+      ::lseek(d, 0, SEEK_SET);
+
+      dq::array<int, 128> a;
+      std::vector<int> v;
+
+      while (dq::read_from(a, d) > 0)
+        for (; !a.empty(); a.pop_front()) v.push_back(a.front());
+
+      assert(v.size() == (d == fd[0] ? 10003u : 10000u));
+      for (int i{}; i != 10000; ++i) assert(v[i] == i);
+    }
+
+    for (auto const p: f) std::fclose(p);
+  }
+
+  { // test_async_flusher_sync, linked fdatasync() after every write
+    using ring_t = dq::array<int, 32>;
+
+    ring_t r;
+    std::FILE* const f(std::tmpfile());
+
+    {
+      dq::async_flusher<ring_t> af(r, fileno(f), 16, true);
+
+      for (int i{}; i != 3000; ++i) assert(af.write(&i, 1) == 1);
+
+      af.flush();
+      assert(r.empty() && !af.error());
+    }
+
+    ::lseek(fileno(f), 0, SEEK_SET);
+
+    std::vector<int> v(3001);
+    assert(::read(fileno(f), v.data(), sizeof(int) * v.size()) ==
+      ssize_t(sizeof(int) * 3000));
+
+    for (int i{}; i != 3000; ++i) assert(v[i] == i);
+
+    std::fclose(f);
+  }
+
+  { // test_async_flusher_pipe, elements straddle the pipe buffer
+    struct e { std::uint32_t x[3]; };
+    using ring_t = dq::array<e, 500>;
+
+    int fd[2];
+    assert(!::pipe(fd));
+    ::fcntl(fd[1], F_SETPIPE_SZ, 4096);
+
+    std::uint32_t n{};
+
+    std::thread t([&]{
+      dq::array<e, 300> b;
+
+      while (dq::read_from(b, fd[0]) > 0)
+        for (; !b.empty(); b.pop_front(), ++n)
+          assert((b.front().x[0] == n) && (b.front().x[2] == n));
+    });
+
+    {
+      ring_t r;
+      dq::async_flusher<ring_t> af(r, fd[1]);
+
+      for (std::uint32_t i{}; i != 20000; ++i)
+        assert(af.write(std::array{e{{i, i, i}}}.data(), 1) == 1);
+
+      af.flush();
+      assert(!af.error());
+    }
+
+    ::close(fd[1]); t.join(); ::close(fd[0]);
+    assert(20000 == n);
+  }
+
+  { // test_journal
+    char path[] = "/tmp/dq_journal_XXXXXX";
+    ::close(::mkstemp(path)); ::unlink(path);
+
+    std::deque<std::vector<std::byte>> v; // reference, oldest first
+    std::mt19937 r(31);
+    std::uint64_t s{};
+
+    auto const check([&](auto const& j)
+      {
+        assert(j.front_seq() == s && j.end_seq() == s + v.size());
+      }
+    );
+
+    for (int k{}; k != 20; ++k)
+    {
+      dq::journal<300> j;
+      assert(j.open(path));
+      check(j); // survives close() and open()
+
+      for (int i{}; i != 200; ++i)
+      {
+        if (r() % 2)
+        {
+          std::vector<std::byte> e(r() % 50, std::byte(i));
+          if (j.append(e)) v.push_back(e); else assert(!v.empty());
+        }
+        else if (!v.empty())
+        {
+          assert(std::ranges::equal(j.peek(), v.front()));
+          j.consume(); v.pop_front(); ++s;
+        }
+
+        if (!(r() % 8)) assert(j.sync());
+      }
+
+      assert(j.sync());
+    }
+
+    { // a torn header falls back to the older copy, the ring is rescanned
+      dq::journal<300> j;
+      assert(j.open(path));
+      assert(j.append(std::vector<std::byte>(10)) && j.sync());
+      assert(j.append(std::vector<std::byte>(20)) && j.sync());
+      j.m_[j.g_ % 2 * 512 + 8] ^= std::byte(1);
+      v.emplace_back(10); v.emplace_back(20);
+    }
+
+    {
+      dq::journal<300> j;
+      assert(j.open(path));
+      check(j);
+      assert(j.append(std::vector<std::byte>(11)) && j.sync());
+    }
+
+    assert(!dq::journal<400>().open(path) && EINVAL == errno);
+
+    ::unlink(path);
+  }
+
+  { // test_shm_ring
+    dq::shm_ring<std::uint64_t, 64> q;
+    assert(q.create("dq_shm_ring") && q.empty());
+
+    pid_t pid[2];
+
+    for (std::uint64_t k{}; k != 2; ++k)
+      if (!(pid[k] = ::fork()))
+      { // the child maps the ring again, at another address
+        dq::shm_ring<std::uint64_t, 64> p;
+        if (!p.attach(q.fd())) ::_exit(1);
+
+        for (std::uint64_t i{}; i != 10000; ++i)
+          while (!p.try_push(k << 32 | i)) std::this_thread::yield();
+
+        ::_exit(0);
+      }
+
+    std::uint64_t next[2]{};
+
+    for (int i{}; i != 20000; ++i)
+    {
+      std::uint64_t v;
+      q.pop_wait(v);
+
+      auto& n(next[v >> 32]);
+      assert((v & 0xffffffff) == n++); // per producer FIFO
+    }
+
+    for (auto const p: pid)
+    {
+      int st;
+      ::waitpid(p, &st, 0);
+      assert(WIFEXITED(st) && !WEXITSTATUS(st));
+    }
+
+    assert(q.empty() && (next[0] == 10000) && (next[1] == 10000));
+
+    dq::shm_ring<std::uint64_t, 32> o;
+    assert(!o.attach(q.fd()) && EINVAL == errno);
+  }
+
+  { // test_shm_ring_open, concurrent openers initialize the file once
+    char path[] = "/tmp/dq_shm_XXXXXX";
+    ::close(::mkstemp(path)); ::unlink(path);
+
+    pid_t pid[4];
+
+    for (std::uint64_t k{}; k != 4; ++k)
+      if (!(pid[k] = ::fork()))
+      {
+        dq::shm_ring<std::uint64_t, 4096> p;
+        if (!p.open(path)) ::_exit(1);
+
+        for (std::uint64_t i{}; i != 500; ++i)
+          if (!p.try_push(k << 32 | i)) ::_exit(2);
+
+        ::_exit(0);
+      }
+
+    for (auto const p: pid)
+    {
+      int st;
+      ::waitpid(p, &st, 0);
+      assert(WIFEXITED(st) && !WEXITSTATUS(st));
+    }
+
+    dq::shm_ring<std::uint64_t, 4096> q;
+    assert(q.open(path) && (q.size() == 2000));
+
+    std::uint64_t next[4]{};
+
+    for (std::uint64_t v; q.try_pop(v);)
+      assert((v & 0xffffffff) == next[v >> 32]++);
+
+    assert(std::ranges::all_of(next, [](auto n) { return n == 500; }));
+    ::unlink(path);
+  }
+
+  { // test_save_load
+    std::FILE* const f(std::tmpfile());
+    int const fd(fileno(f));
+
+    dq::array<int, 10> a{1, 2, 3, 4, 5, 6, 7, 8}, b{0, 0, 0};
+    a.pop_front(5); a.push_back(9, 10, 11, 12, 13); // wrapped
+    b.pop_front(2);
+
+    assert(dq::save(a, fd));
+    ::lseek(fd, 0, SEEK_SET);
+    assert(dq::load(b, fd) && (a == b) && (b.first() == b.data()));
+
+    ::lseek(fd, 0, SEEK_SET);
+    dq::array<int, 4> c;
+    assert(!dq::load(c, fd) && (EINVAL == errno) && c.empty());
+
+    ::lseek(fd, 0, SEEK_SET);
+    dq::array<long long, 10> d;
+    assert(!dq::load(d, fd) && (EINVAL == errno));
+
+    ::ftruncate(fd, 0); ::lseek(fd, 0, SEEK_SET); // streamed elements
+    dq::array<std::string, 4> s{"a", "bc", "", "def"}, t{"x"};
+
+    assert(dq::save(s, fd, [](int const fd, std::string const& e)
+      {
+        std::uint32_t const n(e.size());
+        return ::write(fd, &n, sizeof(n)) == sizeof(n) &&
+          ::write(fd, e.data(), n) == n;
+      }));
+
+    ::lseek(fd, 0, SEEK_SET);
+    assert(dq::load(t, fd, [](int const fd, std::string& e)
+      {
+        std::uint32_t n;
+        if (::read(fd, &n, sizeof(n)) != sizeof(n)) return false;
+        e.resize(n);
+        return ::read(fd, e.data(), n) == n;
+      }) && (s == t));
+
+    std::fclose(f);
+  }
+
+  { // test_ring_view
+    int buf[8];
+    std::uint32_t h{5}, t{5}; // owned by someone else
+
+    dq::ring_view<int, std::uint32_t> v(buf, h, t);
+    dq::array<int, 7> a;
+
+    assert(v.empty() && (v.capacity() == 7));
+
+    for (int i{}; i != 10; ++i) v.push_back(i), a.push_back(i);
+    assert(v.full() && (h == 0) && (t == 7) && std::ranges::equal(v, a));
+
+    v.pop_front(2); a.pop_front(2);
+    v.push_front(-1); a.push_front(-1);
+    assert(std::ranges::equal(v, a) && (v.size() == 6) && (v[1] == 5));
+
+    std::ranges::sort(v, std::greater<>()); // random access, in place
+    std::ranges::sort(a, std::greater<>());
+    assert(std::ranges::equal(v, a));
+    assert(std::ranges::equal(v | std::views::reverse,
+      a | std::views::reverse));
+    assert((dq::find(v, 7) - v.begin() == 2) && (dq::find(v, 42) == v.end()));
+
+    auto s(v.split());
+    assert((s[0][0] == buf + h) && (s[0][1] == buf + t) && !s[1][0]);
+
+    int out[7];
+    dq::copy(v, out);
+    assert(std::ranges::equal(std::span(out, 6), a));
+
+    int const in[]{100, 101, 102};
+    assert(v.append(in, 3) == 1 && v.full() && (v.back() == 100));
+
+    h = 6; t = 2; // the owner moves the ring, the view follows
+    s = v.split();
+    assert((v.size() == 4) && (s[0][0] == buf + 6) && (s[0][1] == buf + 8));
+    assert((s[1][0] == buf) && (s[1][1] == buf + 2));
+    assert((v.end() - v.begin() == 4) && (v.begin() + 3 == --v.end()));
+
+    h = t = 0;
+    assert(v.empty() && (v.begin() == v.end()));
+  }
+
+  { // test_ws_deque
+    dq::ws_deque<int, 4> a; // fixed
+    assert(a.push(1) && a.push(2) && a.push(3) && a.push(4) && !a.push(5));
+    assert((*a.steal() == 1) && (*a.pop() == 4) && (a.size() == 2));
+
+    dq::ws_deque<int, 2, dq::NEW> b; // grows
+    for (int i{}; i != 100; ++i) b.push(i);
+    assert((b.size() == 100) && (b.capacity() == 128));
+
+    std::vector<int> v;
+    assert(b.steal_half([&](int const e) { v.push_back(e); }) == 50);
+    assert((v.front() == 0) && (v.back() == 49) && (*b.pop() == 99));
+
+    dq::ws_deque<std::uint32_t, 64, dq::NEW> q;
+    std::atomic<std::uint64_t> sum{}, cnt{};
+    std::atomic<bool> done{};
+    std::vector<std::thread> thieves;
+
+    for (int k{}; k != 3; ++k)
+      thieves.emplace_back([&, k]{
+        while (!done || !q.empty())
+          if (k % 2)
+            q.steal_half([&](auto const e) { sum += e; ++cnt; }, 8);
+          else if (auto const e(q.steal()); e)
+            sum += *e, ++cnt;
+      });
+
+    for (std::uint32_t i{1}; i <= 200000; ++i)
+    {
+      q.push(i);
+      if (!(i % 3)) if (auto const e(q.pop()); e) sum += *e, ++cnt;
+    }
+
+    for (auto e(q.pop()); e; e = q.pop()) sum += *e, ++cnt;
+
+    done = true;
+    for (auto& t: thieves) t.join();
+
+    assert((cnt == 200000) && (sum == 200000ull * 200001 / 2));
+  }
+
+  { // test_thread_pool
+    std::atomic<std::uint64_t> s{};
+
+    {
+      dq::thread_pool<> tp(4);
+
+      std::function<void(int, int)> f([&](int const i, int const j)
+        { // divide and conquer, nested submits go to the worker's deque
+          if (j - i <= 16)
+            for (auto k(i); k != j; ++k) s += k;
+          else
+          {
+            auto const m(i + (j - i) / 2);
+            tp.submit([&f, i, m]{ f(i, m); });
+            tp.submit([&f, m, j]{ f(m, j); });
+          }
+        }
+      );
+
+      tp.submit([&]{ f(0, 100000); });
+      tp.wait_idle();
+      assert(s == 100000ull * 99999 / 2);
+
+      for (int i{}; i != 1000; ++i) tp.submit([&, i]{ s += i; });
+    } // drains
+
+    assert(s == 100000ull * 99999 / 2 + 999 * 1000 / 2);
+  }
+
+  { // test_sharded_ring
+    struct rec { std::uint64_t ts; int tid; };
+
+    dq::sharded_ring<rec, 256, 4> sr;
+    std::atomic<std::uint64_t> clock{};
+    std::vector<std::thread> tv;
+
+    for (int k{}; k != 4; ++k)
+      tv.emplace_back([&, k]{
+        auto w(sr.acquire());
+        assert(w);
+
+        for (int i{}; i != 20000; ++i)
+          while (!w.push(rec{clock++, k})) std::this_thread::yield();
+      });
+
+    std::uint64_t last[4]{}, n{};
+
+    while (n != 80000)
+      n += sr.drain([&](rec const& r)
+        { // FIFO per shard
+          assert(!last[r.tid] || (r.ts > last[r.tid]));
+          last[r.tid] = r.ts;
+        }
+      );
+
+    for (auto& t: tv) t.join();
+    assert(sr.empty());
+
+    { // merged by timestamp
+      auto w0(sr.acquire()), w1(sr.acquire()), w2(sr.acquire());
+      rec const b[]{{1, 0}, {4, 0}, {7, 0}};
+
+      assert(w0.append(b, 3) == 3);
+      w1.push(rec{2, 1}); w1.push(rec{5, 1}); w2.push(rec{3, 2});
+
+      std::vector<std::uint64_t> v;
+      assert(sr.merge<decltype([](rec const& r) noexcept { return r.ts; })>(
+        [&](rec const& r) { v.push_back(r.ts); }) == 6);
+      assert((v == std::vector<std::uint64_t>{1, 2, 3, 4, 5, 7}));
+    }
+
+    auto w(sr.acquire());
+    for (int i{}; i != 256; ++i) assert(w.push(rec{}));
+    assert(!w.push(rec{}) && !w.free() && (sr.drain([](auto&&){}, 10) == 10));
+    assert(w.free() == 10);
+  }
+
+  { // test_seqlock_ring
+    struct tick { std::uint64_t seq, price, check; };
+
+    dq::seqlock_ring<tick, 128> sr;
+    std::atomic<bool> done{};
+    std::atomic<std::uint64_t> checked{};
+
+    assert(sr.empty() && !sr.snapshot<8>().size());
+
+    std::thread w([&]{ // never waits for the readers
+      for (std::uint64_t i{}; i != 200000; ++i)
+        sr.push_back(tick{i, i * 3, ~i});
+      done = true;
+    });
+
+    std::vector<std::thread> rv;
+
+    for (int k{}; k != 3; ++k)
+      rv.emplace_back([&]{
+        tick t[64];
+
+        while (!done)
+        {
+          auto const n(sr.snapshot(t, 64));
+
+          for (std::size_t i{}; i != n; ++i) // consistent and contiguous
+            assert((t[i].price == t[i].seq * 3) &&
+              (t[i].check == ~t[i].seq) &&
+              (!i || (t[i].seq == t[i - 1].seq + 1)));
+
+          checked += n;
+        }
+      });
+
+    w.join();
+    for (auto& t: rv) t.join();
+
+    auto const a(sr.snapshot<16>());
+    assert((a.size() == 16) && (a.back().seq == 199999) &&
+      (a.front().seq == 199984) && (sr.size() == 128));
+
+    tick const b[]{{7, 21, ~7ull}, {8, 24, ~8ull}};
+    sr.append(b, 2);
+
+    tick t;
+    assert(sr.back(t) && (t.seq == 8) && (sr.end_seq() == 200002));
+  }
+
+  { // test_spsc_ring
+    dq::spsc_ring<std::uint64_t, 16> q;
+    std::uint64_t sum{};
+
+    std::thread c([&]{
+      for (int i{}; i != 100000; ++i) sum += q.pop_wait();
+    });
+
+    for (std::uint64_t i{}; i != 100000; ++i) q.push_wait(i);
+    c.join();
+
+    assert(q.empty() && (sum == 100000ull * 99999 / 2));
+
+    { // an idle consumer sleeps until it is notified
+      dq::spsc_ring<std::string, 4, dq::NEW> s;
+      std::string r;
+
+      std::thread c([&]{ r = s.pop_wait(); });
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      s.push_wait(std::string("late"));
+      c.join();
+
+      assert(r == "late");
+    }
+
+    auto const t0(std::chrono::steady_clock::now());
+    assert(!q.pop_wait_for(std::chrono::milliseconds(5)));
+    assert(std::chrono::steady_clock::now() - t0 >=
+      std::chrono::milliseconds(5));
+
+    for (std::uint64_t i{}; i != 16; ++i) assert(q.try_push(i));
+    assert(!q.try_push(16) &&
+      !q.push_wait_for(16, std::chrono::milliseconds(1)));
+    assert((*q.try_pop() == 0) && q.push_wait_for(16, std::chrono::seconds(1)));
+
+    { // a timed waiter sleeps too, and a push wakes it before its timeout
+      dq::spsc_ring<int, 4> s;
+      std::optional<int> r;
+
+      auto const t0(std::chrono::steady_clock::now());
+      std::thread c([&]{ r = s.pop_wait_for(std::chrono::seconds(30)); });
+
+      while (!s.wc_.load()) std::this_thread::yield();
+      assert(s.try_push(7));
+      c.join();
+
+      assert((r == 7) && (std::chrono::steady_clock::now() - t0 <
+        std::chrono::seconds(10)));
+    }
+  }
+
+  { // test_disruptor
+    // journaler and replicator read every slot, business logic follows both
+    dq::disruptor<std::uint64_t, 64, 4> d;
+
+    auto const jr(d.add_consumer()), rp(d.add_consumer());
+    auto const bl(d.add_consumer({jr, rp}));
+
+    std::uint64_t js{}, rs{}, bs{};
+    bool jo{true}, ro{true}, bo{true};
+
+    auto const consume([&](auto const i, auto& sum, bool& ordered,
+      bool const check)
+      {
+        for (std::uint64_t s{}; s != 100000;)
+        {
+          d.wait_for(i, s);
+          s += d.poll(i, [&](auto const v, auto const q, bool)
+            {
+              ordered = ordered && (v == q) && (!check ||
+                ((d.sequence_of(jr) > q) && (d.sequence_of(rp) > q)));
+              sum += v;
+            }
+          );
+        }
+      }
+    );
+
+    std::thread t0([&]{ consume(jr, js, jo, false); });
+    std::thread t1([&]{ consume(rp, rs, ro, false); });
+    std::thread t2([&]{ consume(bl, bs, bo, true); });
+
+    for (std::uint64_t i{}; i != 100000;)
+      if (i % 5)
+        d.publish(i++);
+      else
+      { // a batch of 3
+        auto const s(d.next(3));
+        for (std::uint64_t j{}; j != 3; ++j) d.slot(s + j) = i++;
+        d.publish();
+      }
+
+    t0.join(); t1.join(); t2.join();
+
+    auto const sum(100000ull * 99999 / 2);
+    assert(jo && ro && bo && (js == sum) && (rs == sum) && (bs == sum));
+    assert(d.available(bl) == 100000);
+
+    { // the producer is gated by the slowest consumer
+      dq::disruptor<int, 4, 2, dq::NEW> g;
+
+      auto const a(g.add_consumer());
+
+      for (int i{}; i != 4; ++i) assert(g.try_next()), g.slot(i) = i;
+      g.publish();
+
+      assert(!g.try_next() && (g.available(a) == 4) && (g[2] == 2));
+      g.release(a, 1);
+      assert(g.try_next() && !g.try_next());
+    }
+  }
 }
 
 int main() {
@@ -0,0 +1,164 @@
+#ifndef DQ_CIRCULAR_ARENA_HPP
+# define DQ_CIRCULAR_ARENA_HPP
+# pragma once
+
+#include <cstddef> // std::byte, std::max_align_t
+#include <cstring> // std::memcpy()
+#include <memory_resource>
+
+#include "array.hpp"
+
+namespace dq
+{
+
+template <std::size_t CAP_BYTES, enum Method M = MEMBER>
+requires(CAP_BYTES >= 64)
+class circular_arena
+{ // FIFO allocator, blocks are carved at l_ and reclaimed from f_
+public:
+  using size_type = std::size_t;
+
+//private:
+  struct prefix { size_type len, freed; }; // at the start of every block
+
+  enum : size_type { P = sizeof(prefix), H = P + sizeof(size_type) };
+
+  array<std::byte, CAP_BYTES, M> r_;
+  std::pmr::memory_resource* u_; // upstream, for whatever does not fit
+
+  auto end_() const noexcept { return r_.data() + (CAP_BYTES + 1); }
+
+  static auto align_(std::byte* const p, size_type const a) noexcept
+  {
+    return p + (-reinterpret_cast<std::uintptr_t>(p) & (a - 1));
+  }
+
+  static prefix load_(std::byte const* const p) noexcept
+  {
+    prefix r; std::memcpy(&r, p, P); return r;
+  }
+
+  static void store_(std::byte* const p, prefix const& v) noexcept
+  {
+    std::memcpy(p, &v, P);
+  }
+
+  void reclaim_() noexcept
+  { // pops freed blocks and wrap padding from the tail of the ring
+    while (!r_.empty())
+    {
+      auto const f(r_.first());
+
+      if (size_type const t(end_() - f); t < P)
+        r_.pop_front(t);
+      else if (auto const b(load_(f)); b.freed)
+        r_.pop_front(b.len);
+      else
+        break;
+    }
+  }
+
+public:
+  explicit circular_arena(std::pmr::memory_resource* const u =
+    std::pmr::new_delete_resource()) noexcept:
+    u_(u)
+  {
+  }
+
+  circular_arena(circular_arena const&) = delete;
+  circular_arena& operator=(circular_arena const&) = delete;
+
+  //
+  size_type size() const noexcept { return r_.size(); }
+  bool empty() const noexcept { return r_.empty(); }
+
+  static constexpr size_type capacity() noexcept { return CAP_BYTES; }
+
+  bool owns(void const* const p) const noexcept
+  {
+    return std::less_equal<>()(r_.data(), p) && std::less<>()(p, end_());
+  }
+
+  auto upstream() const noexcept { return u_; }
+
+  //
+  void* allocate(size_type const n,
+    size_type const a = alignof(std::max_align_t))
+  { // falls back to the upstream resource when the ring has no room
+    auto l(r_.last());
+    size_type pad{};
+
+    auto const len([&]() noexcept
+      { // block length, rounded up to keep prefixes word aligned
+        return (align_(l + H, a) + n - l + (P - 1)) & ~size_type(P - 1);
+      }
+    );
+
+    auto b(len());
+
+    if (size_type const t(end_() - l); b > t) // wrap
+      pad = t, l = r_.data(), b = len();
+
+    if (pad + b > CAP_BYTES - r_.size()) return u_->allocate(n, a);
+
+    if (pad >= P) store_(r_.last(), {pad, 1});
+
+    auto const p(align_(l + H, a));
+    store_(l, {b, 0});
+    size_type const o(p - l); std::memcpy(p - sizeof(o), &o, sizeof(o));
+
+    r_.resize(r_.size() + pad + b);
+
+    return p;
+  }
+
+  void deallocate(void* const p, size_type const n,
+    size_type const a = alignof(std::max_align_t)) noexcept
+  { // out of order frees are only marked, reclaimed with the older blocks
+    if (owns(p))
+    {
+      auto const q(static_cast<std::byte*>(p));
+
+      size_type o; std::memcpy(&o, q - sizeof(o), sizeof(o));
+      auto const l(q - o);
+
+      auto b(load_(l)); b.freed = 1; store_(l, b);
+
+      reclaim_();
+    }
+    else
+      u_->deallocate(p, n, a);
+  }
+};
+
+template <typename A>
+class arena_resource: public std::pmr::memory_resource
+{ // std::pmr adaptor for an arena
+  A& a_;
+
+  void* do_allocate(std::size_t const n, std::size_t const a) override
+  {
+    return a_.allocate(n, a);
+  }
+
+  void do_deallocate(void* const p, std::size_t const n,
+    std::size_t const a) override
+  {
+    a_.deallocate(p, n, a);
+  }
+
+  bool do_is_equal(std::pmr::memory_resource const& o) const noexcept
+    override
+  {
+    return this == &o;
+  }
+
+public:
+  explicit arena_resource(A& a) noexcept: a_(a) { }
+
+  auto& arena() const noexcept { return a_; }
+};
+
+}
+
+#endif // DQ_CIRCULAR_ARENA_HPP
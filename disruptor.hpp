@@ -0,0 +1,202 @@
+#ifndef DQ_DISRUPTOR_HPP
+# define DQ_DISRUPTOR_HPP
+# pragma once
+
+#include <initializer_list>
+#include <memory> // std::unique_ptr
+
+#include "array.hpp"
+#include "wait.hpp"
+
+namespace dq
+{
+
+template <typename T, std::size_t CAP, std::size_t C = 8,
+  enum Method M = MEMBER>
+requires(
+  std::is_default_constructible_v<T> &&
+  std::has_single_bit(CAP) &&
+  (C > 0) && (C <= 64)
+)
+class disruptor
+{ // one producer publishes into preallocated slots, every consumer reads
+  // them in place at its own sequence, possibly behind other consumers
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using seq_type = std::uint64_t;
+
+//private:
+  enum : seq_type { MASK = CAP - 1 };
+
+  struct alignas(64) sequence
+  { // elements below s are done, w counts the threads sleeping on s
+    std::atomic<seq_type> s{};
+    mutable std::atomic<unsigned> w{};
+  };
+
+  sequence p_; // published by the producer
+  seq_type n_{}, g_{}; // next claim, cached gating sequence
+
+  sequence c_[C]; // consumed, per consumer
+  std::uint64_t d_[C]{}; // per consumer bitmask of the consumers it follows
+  size_type k_{}; // consumers
+
+  std::conditional_t<MEMBER == M, T[CAP], std::unique_ptr<T[]>> a_;
+
+  seq_type gate_() const noexcept
+  { // the slowest consumer
+    auto r(n_);
+
+    for (size_type i{}; i != k_; ++i)
+      r = std::min(r, c_[i].s.load(std::memory_order_acquire));
+
+    return r;
+  }
+
+  template <typename F>
+  void barrier_(size_type const i, F const f) const
+    noexcept(noexcept(f(p_)))
+  { // the sequences consumer i follows
+    if (auto m(d_[i]); !m)
+      f(p_);
+    else
+      for (; m; m &= m - 1) f(c_[std::countr_zero(m)]);
+  }
+
+public:
+  disruptor() requires(MEMBER == M) = default;
+  disruptor() requires(NEW == M): a_(new T[CAP]) { }
+
+  disruptor(disruptor const&) = delete;
+  disruptor& operator=(disruptor const&) = delete;
+
+  //
+  static constexpr size_type capacity() noexcept { return CAP; }
+
+  size_type consumers() const noexcept { return k_; }
+
+  size_type add_consumer(std::initializer_list<size_type> const deps = {})
+    noexcept
+  { // before anything is published, deps are earlier consumers whose
+    // sequences gate this one, none means it follows the producer
+    for (auto const j: deps) d_[k_] |= std::uint64_t(1) << j;
+
+    c_[k_].s.store(p_.s.load(std::memory_order_relaxed),
+      std::memory_order_relaxed);
+
+    return k_++; // < C
+  }
+
+  T const& operator[](seq_type const s) const noexcept
+  {
+    return a_[s & MASK];
+  }
+
+  // the producer
+  seq_type cursor() const noexcept
+  {
+    return p_.s.load(std::memory_order_acquire);
+  }
+
+  bool try_next(size_type const n = 1) noexcept
+  { // claims n (<= CAP) slots without waiting, see next()
+    return ((n_ + n - g_ <= CAP) || (n_ + n - (g_ = gate_()) <= CAP)) &&
+      (n_ += n, true);
+  }
+
+  seq_type next(size_type const n = 1) noexcept
+  { // claims n (<= CAP) slots, waits for the slowest consumer, returns the
+    // first claimed sequence; fill them via slot(), then publish()
+    while (n_ + n - g_ > CAP)
+    {
+      auto const need(n_ + n - CAP); // consumers have to get past this
+
+      for (size_type i{}; i != k_; ++i)
+        detail::park(c_[i].s, c_[i].w, [&]() noexcept
+          {
+            return c_[i].s.load(std::memory_order_acquire) >= need;
+          }
+        );
+
+      g_ = gate_();
+    }
+
+    return std::exchange(n_, n_ + n);
+  }
+
+  T& slot(seq_type const s) noexcept { return a_[s & MASK]; }
+
+  void publish() noexcept
+  { // everything claimed so far
+    p_.s.store(n_, std::memory_order_release);
+
+    detail::unpark(p_.s, p_.w);
+  }
+
+  void publish(auto&& v)
+    noexcept(std::is_nothrow_assignable_v<T&, decltype(v)>)
+    requires(std::is_assignable_v<T&, decltype(v)>)
+  {
+    slot(next()) = std::forward<decltype(v)>(v); publish();
+  }
+
+  // consumers
+  seq_type sequence_of(size_type const i) const noexcept
+  {
+    return c_[i].s.load(std::memory_order_relaxed);
+  }
+
+  seq_type available(size_type const i) const noexcept
+  { // elements below the returned sequence may be read by consumer i
+    auto r(~seq_type{});
+
+    barrier_(i, [&](sequence const& q) noexcept
+      {
+        r = std::min(r, q.s.load(std::memory_order_acquire));
+      }
+    );
+
+    return r;
+  }
+
+  seq_type wait_for(size_type const i, seq_type const s) noexcept
+  { // blocks until element s is readable by consumer i
+    barrier_(i, [&](sequence const& q) noexcept
+      {
+        detail::park(q.s, q.w, [&]() noexcept
+          {
+            return q.s.load(std::memory_order_acquire) > s;
+          }
+        );
+      }
+    );
+
+    return available(i);
+  }
+
+  void release(size_type const i, seq_type const s) noexcept
+  { // consumer i is done with every element below s
+    c_[i].s.store(s, std::memory_order_release);
+
+    detail::unpark(c_[i].s, c_[i].w);
+  }
+
+  size_type poll(size_type const i, auto&& f, size_type const max = -1)
+    noexcept(noexcept(f(std::declval<T const&>(), seq_type{}, true)))
+  { // f(e, seq, end_of_batch) for every readable element, then one release
+    auto const b(sequence_of(i));
+    auto const e(b + std::min(seq_type(max), available(i) - b));
+
+    for (auto s(b); s != e; ++s)
+      f(std::as_const(a_[s & MASK]), s, s + 1 == e);
+
+    if (e != b) release(i, e);
+
+    return e - b;
+  }
+};
+
+}
+
+#endif // DQ_DISRUPTOR_HPP
@@ -0,0 +1,103 @@
+#ifndef DQ_FIR_HPP
+# define DQ_FIR_HPP
+# pragma once
+
+#include <numeric> // std::transform_reduce()
+#include <span>
+
+#include "array.hpp"
+
+namespace dq
+{
+
+template <typename T, std::size_t TAPS, std::size_t BLK = 256,
+  enum Method M = MEMBER, auto E = std::execution::unseq>
+requires(std::is_arithmetic_v<T> && (BLK > 0))
+class fir
+{ // y[n] = h[0] * x[n] + h[1] * x[n - 1] + ... + h[TAPS - 1] * x[n - TAPS + 1]
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+//private:
+  array<T, TAPS, M, E> d_; // delay line, oldest sample first, always full
+  T h_[TAPS]; // taps, reversed to match the delay line order
+  T s_[TAPS + BLK]; // linear scratch for block mode
+
+  static constexpr T dot_(T const* const i, T const* const j,
+    T const* const h) noexcept
+  {
+    if (std::is_constant_evaluated())
+      return std::transform_reduce(i, j, h, T{});
+    else
+      return std::transform_reduce(E, i, j, h, T{});
+  }
+
+public:
+  constexpr fir() noexcept: d_(TAPS, T{}), h_{} { }
+
+  constexpr explicit fir(std::span<T const, TAPS> const h) noexcept:
+    d_(TAPS, T{})
+  {
+    taps(h);
+  }
+
+  constexpr fir(std::initializer_list<T> const l) noexcept:
+    d_(TAPS, T{}), h_{}
+  { // missing taps are zero
+    std::reverse_copy(l.begin(), l.begin() + std::min(l.size(), TAPS),
+      h_ + (TAPS - std::min(l.size(), TAPS)));
+  }
+
+  //
+  constexpr auto& delay_line() const noexcept { return d_; }
+
+  static constexpr size_type size() noexcept { return TAPS; }
+
+  constexpr void reset() noexcept { std::fill(d_.begin(), d_.end(), T{}); }
+
+  constexpr void taps(std::span<T const, TAPS> const h) noexcept
+  {
+    std::reverse_copy(h.begin(), h.end(), h_);
+  }
+
+  //
+  constexpr T operator()(T const x) noexcept
+  { // push a sample, dot product over the (at most) two contiguous segments
+    d_.push_back(x);
+
+    T r{};
+    auto h(h_);
+
+    for (auto const [i, j]: d_.split())
+    {
+      if (i == j) break;
+
+      r += dot_(i, j, h); h += j - i;
+    }
+
+    return r;
+  }
+
+  constexpr void process(T const* in, T* out, size_type n) noexcept
+  { // block mode, the history is linearized once per BLK samples
+    while (n)
+    {
+      auto const c(std::min(n, BLK));
+
+      dq::copy(d_, s_);
+      std::copy_n(in, c, s_ + TAPS);
+
+      for (size_type i{}; i != c; ++i)
+        out[i] = dot_(s_ + i + 1, s_ + i + 1 + TAPS, h_);
+
+      d_.clear(); d_.append(s_ + c, TAPS);
+
+      in += c; out += c; n -= c;
+    }
+  }
+};
+
+}
+
+#endif // DQ_FIR_HPP
@@ -0,0 +1,107 @@
+#ifndef DQ_FRAME_HPP
+# define DQ_FRAME_HPP
+# pragma once
+
+#include <cstring> // std::memchr()
+#include <span>
+#include <string_view>
+
+#include "array.hpp"
+
+namespace dq
+{
+
+namespace detail
+{
+
+template <typename T>
+using frame_view_t = std::conditional_t<
+  std::is_same_v<T, char> || std::is_same_v<T, char8_t>,
+  std::basic_string_view<T>, std::span<T const>>;
+
+template <typename T>
+constexpr T const* find_byte(T const* const i, T const* const j,
+  T const d) noexcept
+{ // memchr() is vectorized by every libc worth its salt
+  if (std::is_constant_evaluated())
+    return std::find(i, j, d);
+  else if (auto const p(std::memchr(i,
+    std::bit_cast<unsigned char>(d), j - i)); p)
+    return static_cast<T const*>(p);
+  else
+    return j;
+}
+
+}
+
+template <typename V>
+struct frame
+{ // a frame as one or two views into the ring, no copies
+  std::array<V, 2> parts;
+  std::size_t consumed; // frame length + delimiter, 0 if there is no frame
+
+  constexpr explicit operator bool() const noexcept { return consumed; }
+
+  constexpr auto size() const noexcept
+  {
+    return parts[0].size() + parts[1].size();
+  }
+};
+
+template <typename T, auto S, auto M, auto E>
+constexpr auto find_delimiter(array<T, S, M, E> const& c, T const d) noexcept
+  requires(sizeof(T) == 1)
+{ // scans the (at most) two split() segments, not byte by byte
+  using view_t = detail::frame_view_t<T>;
+
+  frame<view_t> r{};
+  auto const s(c.split());
+
+  for (std::size_t o{}; auto const [i, j]: s)
+  {
+    if (i == j) break;
+
+    if (auto const p(detail::find_byte(i, j, d)); p != j)
+    {
+      if (o)
+        r.parts = {view_t(s[0][0], o), view_t(i, p - i)};
+      else
+        r.parts[0] = view_t(i, p - i);
+
+      r.consumed = o + (p - i) + 1;
+
+      break;
+    }
+
+    o += j - i;
+  }
+
+  return r;
+}
+
+template <typename T, auto S, auto M, auto E>
+constexpr auto next_line(array<T, S, M, E> const& c) noexcept
+  requires(sizeof(T) == 1)
+{ // '\n' terminated, a trailing '\r' is not part of the frame
+  auto r(find_delimiter(c, T('\n')));
+
+  for (auto& v: r.parts | std::views::reverse)
+    if (!v.empty())
+    {
+      if (T('\r') == v.back()) v = {v.data(), v.size() - 1};
+
+      break;
+    }
+
+  return r;
+}
+
+template <typename T, auto S, auto M, auto E, typename V>
+constexpr void consume(array<T, S, M, E>& c, frame<V> const& f) noexcept
+{ // bulk pops the frame and its delimiter
+  c.pop_front(f.consumed);
+}
+
+}
+
+#endif // DQ_FRAME_HPP
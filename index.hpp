@@ -0,0 +1,91 @@
+#ifndef DQ_INDEX_HPP
+# define DQ_INDEX_HPP
+# pragma once
+
+#include <cstdint> // std::uint64_t
+#include <algorithm> // std::fill_n()
+#include <bit> // std::bit_ceil()
+#include <type_traits>
+
+namespace dq::detail
+{
+
+constexpr std::size_t mix(auto const h, std::uint64_t const s,
+  unsigned const b) noexcept
+{ // multiplicative hashing, returns the top b bits
+  return (std::uint64_t(h) * s) >> (64 - b);
+}
+
+template <std::size_t CAP>
+class index
+{ // linear probing index of at most CAP positions, the keys live elsewhere
+public:
+  using size_type = std::size_t;
+
+  enum : size_type { B = std::bit_ceil(2 * CAP) }; // buckets
+
+//private:
+  using pos_t = std::conditional_t<(CAP < UINT32_MAX), std::uint32_t,
+    size_type>;
+
+  pos_t x_[B]{}; // position + 1, 0 marks an empty bucket
+
+public:
+  static constexpr size_type home(auto const h) noexcept
+  {
+    return mix(h, 0x9e3779b97f4a7c15u, std::countr_zero(+B));
+  }
+
+  constexpr bool used(size_type const i) const noexcept { return x_[i]; }
+  constexpr size_type pos(size_type const i) const noexcept
+  {
+    return x_[i] - 1;
+  }
+
+  constexpr void set(size_type const i, size_type const p) noexcept
+  {
+    x_[i] = p + 1;
+  }
+
+  constexpr void clear() noexcept { std::fill_n(x_, size_type(B), pos_t{}); }
+
+  constexpr size_type find(auto const h, auto&& eq) const
+    noexcept(noexcept(eq(size_type{})))
+  { // returns the bucket of the matching position or the empty bucket
+    auto i(home(h));
+
+    for (; x_[i] && !eq(size_type(x_[i] - 1)); i = (i + 1) & (B - 1));
+
+    return i;
+  }
+
+  constexpr void erase(size_type i, auto&& hash, auto&& moved)
+    noexcept(noexcept(hash(size_type{}), moved(size_type{}, size_type{})))
+  { // backward shift deletion, no tombstones
+    for (auto j(i);;)
+    {
+      x_[i] = {};
+
+      for (;;)
+      {
+        if (!x_[j = (j + 1) & (B - 1)]) return;
+
+        auto const h(home(hash(size_type(x_[j] - 1))));
+
+        if (i <= j ? (i >= h) || (h > j) : (i >= h) && (h > j)) break;
+      }
+
+      moved(size_type((x_[i] = x_[j]) - 1), i); i = j;
+    }
+  }
+
+  constexpr void erase(size_type const i, auto&& hash)
+    noexcept(noexcept(hash(size_type{})))
+  {
+    erase(i, hash, [](size_type, size_type) noexcept {});
+  }
+};
+
+}
+
+#endif // DQ_INDEX_HPP
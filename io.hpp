@@ -0,0 +1,233 @@
+#ifndef DQ_IO_HPP
+# define DQ_IO_HPP
+# pragma once
+
+#include <cerrno> // errno
+#include <poll.h> // ::poll()
+#include <sys/uio.h> // ::readv(), ::writev()
+#include <unistd.h> // ::read(), ::write()
+
+#include "array.hpp"
+
+namespace dq
+{
+
+namespace detail
+{
+
+template <typename T>
+inline int iovecs(iovec* const v, std::array<std::span<T>, 2> const& s,
+  std::size_t n) noexcept
+{ // at most n elements of s, returns the number of iovecs
+  int c{};
+
+  for (auto const& e: s)
+    if (auto const k(std::min(n, e.size())); k)
+      v[c++] = {const_cast<std::remove_const_t<T>*>(e.data()), k * sizeof(T)},
+      n -= k;
+
+  return c;
+}
+
+inline auto at(iovec const (&v)[2], std::size_t const r) noexcept
+{ // the byte at offset r of the iovecs
+  return static_cast<char*>(v[0].iov_len > r ? v[0].iov_base : v[1].iov_base)
+    + (v[0].iov_len > r ? r : r - v[0].iov_len);
+}
+
+inline bool ready(int const fd, short const ev) noexcept
+{ // after a failed transfer, true if it may be retried, waits on EAGAIN
+  if (EINTR == errno)
+    return true;
+  else if ((EAGAIN != errno) && (EWOULDBLOCK != errno))
+    return false;
+
+  for (pollfd p{fd, ev, {}}; ::poll(&p, 1, -1) < 0;)
+    if (EINTR != errno) return false;
+
+  return true;
+}
+
+template <typename T>
+inline std::size_t complete(auto const f, int const fd, short const ev,
+  iovec const (&v)[2], std::size_t r) noexcept
+{ // transfers the rest of a partially transferred element, if any,
+  // returns the bytes transferred, not a multiple of sizeof(T) on error
+  for (auto k(r % sizeof(T) ? sizeof(T) - r % sizeof(T) : 0); k;)
+  {
+    if (auto const t(f(fd, at(v, r), k)); t > 0)
+      r += t, k -= t;
+    else if (!t)
+    {
+      errno = EIO; break; // premature end of file
+    }
+    else if (!ready(fd, ev))
+      break;
+  }
+
+  return r;
+}
+
+inline bool transfer_all(auto const f, int const fd, short const ev,
+  iovec* v, int c) noexcept
+{ // readv()/writev() until every iovec is done, premature EOF is EIO
+  while (c)
+    if (auto r(f(fd, v, c)); r > 0)
+    {
+      for (; c && (std::size_t(r) >= v->iov_len); --c) r -= v++->iov_len;
+
+      if (c) v->iov_base = static_cast<char*>(v->iov_base) + r,
+        v->iov_len -= r;
+    }
+    else if (!r)
+    {
+      errno = EIO; return false;
+    }
+    else if (!ready(fd, ev))
+      return false;
+
+  return true;
+}
+
+struct snapshot
+{ // native byte order, elem is 0 for streamed elements
+  std::uint64_t magic, size, elem;
+};
+
+inline constexpr std::uint64_t snapshot_magic{0x31305041534e5144};
+
+inline bool load_header(int const fd, std::size_t const elem,
+  std::size_t const cap, std::size_t& n) noexcept
+{
+  snapshot h;
+  iovec v{&h, sizeof(h)};
+
+  if (!transfer_all(::readv, fd, POLLIN, &v, 1)) return false;
+
+  if ((snapshot_magic != h.magic) || (elem != h.elem) || (h.size > cap))
+  {
+    errno = EINVAL; return false;
+  }
+
+  n = h.size; return true;
+}
+
+}
+
+template <typename T, auto S, auto M, auto E>
+inline std::ptrdiff_t read_from(array<T, S, M, E>& a, int const fd,
+  std::size_t const max = -1) noexcept
+  requires(std::is_trivially_copyable_v<T>)
+{ // one readv() straight into the free region, returns elements read,
+  // 0 on end of file or a full ring, -1 on error (see errno); an element
+  // torn by an error or end of file is dropped, the whole ones before it
+  // are still committed
+  iovec v[2];
+
+  if (auto const c(detail::iovecs(v, a.prepare(max), max)); !c)
+    return 0;
+  else if (auto const r(::readv(fd, v, c)); r <= 0)
+    return r;
+  else
+  {
+    auto const b(detail::complete<T>(::read, fd, POLLIN, v, r));
+
+    a.commit(b / sizeof(T));
+
+    return b % sizeof(T) ? -1 : std::ptrdiff_t(b / sizeof(T));
+  }
+}
+
+template <typename T, auto S, auto M, auto E>
+inline std::ptrdiff_t write_to(array<T, S, M, E>& a, int const fd,
+  std::size_t const max = -1) noexcept
+  requires(std::is_trivially_copyable_v<T>)
+{ // one writev() straight from the filled region, returns elements
+  // written, 0 for an empty ring, -1 on error (see errno); an element
+  // torn by an error is consumed, as its head is already on fd
+  iovec v[2];
+
+  if (auto const c(detail::iovecs(v, a.data_spans(), max)); !c)
+    return 0;
+  else if (auto const r(::writev(fd, v, c)); r <= 0)
+    return r;
+  else
+  {
+    auto const b(detail::complete<T>(
+      [](int const fd, void const* const p, std::size_t const k) noexcept
+      {
+        return ::write(fd, p, k);
+      }, fd, POLLOUT, v, r));
+
+    a.consume((b + sizeof(T) - 1) / sizeof(T));
+
+    return b % sizeof(T) ? -1 : std::ptrdiff_t(b / sizeof(T));
+  }
+}
+
+template <typename T, auto S, auto M, auto E>
+inline bool save(array<T, S, M, E> const& a, int const fd) noexcept
+  requires(std::is_trivially_copyable_v<T>)
+{ // one writev(): a header, then the (at most) two split() segments
+  detail::snapshot h{detail::snapshot_magic, a.size(), sizeof(T)};
+  iovec v[3]{{&h, sizeof(h)}};
+
+  return detail::transfer_all(::writev, fd, POLLOUT, v,
+    1 + detail::iovecs(v + 1, a.data_spans(), -1));
+}
+
+template <typename T, auto S, auto M, auto E>
+inline bool save(array<T, S, M, E> const& a, int const fd, auto&& f)
+  noexcept(noexcept(f(fd, std::declval<T const&>())))
+{ // f(fd, e) streams one element, false on error
+  detail::snapshot h{detail::snapshot_magic, a.size(), {}};
+  iovec v{&h, sizeof(h)};
+
+  return detail::transfer_all(::writev, fd, POLLOUT, &v, 1) &&
+    std::ranges::all_of(a, [&](auto const& e) noexcept(noexcept(f(fd, e)))
+      { return f(fd, e); });
+}
+
+template <typename T, auto S, auto M, auto E>
+inline bool load(array<T, S, M, E>& a, int const fd) noexcept
+  requires(std::is_trivially_copyable_v<T>)
+{ // reads straight into data(), the ring comes back linearized, or empty
+  // on error
+  std::size_t n;
+
+  a.reset();
+
+  if (!detail::load_header(fd, sizeof(T), S, n)) return false;
+
+  iovec v{a.data(), n * sizeof(T)};
+
+  if (n && !detail::transfer_all(::readv, fd, POLLIN, &v, 1)) return false;
+
+  a.commit(n); return true;
+}
+
+template <typename T, auto S, auto M, auto E>
+inline bool load(array<T, S, M, E>& a, int const fd, auto&& f)
+  noexcept(noexcept(f(fd, std::declval<T&>())) &&
+    std::is_nothrow_move_assignable_v<T>)
+{ // f(fd, e) streams one element into a default constructed e
+  std::size_t n;
+
+  a.clear();
+
+  if (!detail::load_header(fd, {}, S, n)) return false;
+
+  for (; n; --n)
+    if (T e{}; f(fd, e))
+      a.push_back(std::move(e));
+    else
+    {
+      a.clear(); return false;
+    }
+
+  return true;
+}
+
+}
+
+#endif // DQ_IO_HPP
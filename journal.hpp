@@ -0,0 +1,306 @@
+#ifndef DQ_JOURNAL_HPP
+# define DQ_JOURNAL_HPP
+# pragma once
+
+#include <cerrno> // errno
+#include <cstddef> // std::byte, offsetof
+#include <cstring> // std::memcpy()
+#include <span>
+
+#include <fcntl.h> // ::open()
+#include <sys/mman.h> // ::mmap(), ::msync()
+#include <sys/stat.h> // ::fstat()
+#include <unistd.h> // ::close(), ::ftruncate(), ::sysconf()
+
+#include "array.hpp"
+
+namespace dq
+{
+
+namespace detail
+{
+
+inline constexpr auto crc32c_table{[]() noexcept
+  {
+    std::array<std::uint32_t, 256> t;
+
+    for (std::uint32_t i{}; i != t.size(); ++i)
+    {
+      auto c(i);
+      for (int k{}; k != 8; ++k) c = c & 1 ? 0x82f63b78 ^ c >> 1 : c >> 1;
+      t[i] = c;
+    }
+
+    return t;
+  }()
+};
+
+inline std::uint32_t crc32c(void const* const p, std::size_t n,
+  std::uint32_t c = {}) noexcept
+{ // Castagnoli, reflected, chainable
+  c = ~c;
+
+  for (auto q(static_cast<unsigned char const*>(p)); n; --n)
+    c = crc32c_table[(c ^ *q++) & 0xff] ^ c >> 8;
+
+  return ~c;
+}
+
+}
+
+template <std::size_t CAP_BYTES>
+requires((CAP_BYTES > 8) && (CAP_BYTES - 8 < std::uint32_t(-1))) // < SKIP
+class journal
+{ // durable record ring in an mmap()ed file, offsets instead of pointers
+public:
+  using size_type = std::size_t;
+  using seq_type = std::uint64_t;
+  using const_span_type = std::span<std::byte const>;
+
+  enum : size_type { H = 8 }; // record header: length, crc32c of seq + data
+
+//private:
+  enum : size_type { N = CAP_BYTES + 1, PAGE = 4096, SLOT = 512 };
+  enum : std::uint32_t { SKIP = std::uint32_t(-1) }; // wrap marker
+  enum : std::uint64_t { MAGIC = 0x31304c4e524a5144 };
+
+  struct header
+  { // two copies in the first page, the one with the higher gen wins
+    std::uint64_t magic, cap, gen;
+    std::uint64_t f, l; // ring offsets
+    seq_type sf, sl; // sequence numbers of the records at f and l
+    std::uint32_t crc;
+  };
+
+  int fd_{-1};
+  std::byte* m_{}; // the mapping, header page followed by N ring bytes
+
+  size_type f_{}, l_{}; // offsets of the first record and the free space
+  seq_type sf_{}, sl_{};
+  std::uint64_t g_{};
+
+  size_type d_{}, w_{}; // unsynced bytes: start and count
+
+  auto a_() const noexcept { return m_ + PAGE; }
+
+  std::uint32_t load_(size_type const o) const noexcept
+  {
+    std::uint32_t r; std::memcpy(&r, a_() + o, sizeof(r)); return r;
+  }
+
+  void store_(size_type const o, std::uint32_t const v) const noexcept
+  {
+    std::memcpy(a_() + o, &v, sizeof(v));
+  }
+
+  static std::uint32_t crc_(seq_type const s, std::byte const* const p,
+    size_type const n) noexcept
+  { // a stale record from an earlier lap has the wrong seq
+    return detail::crc32c(p, n, detail::crc32c(&s, sizeof(s)));
+  }
+
+  static std::uint32_t crc_(header const& h) noexcept
+  {
+    return detail::crc32c(&h, offsetof(header, crc));
+  }
+
+  size_type pad_(size_type const o) const noexcept
+  { // bytes to skip at o, the tail is skipped if it can not hold a header
+    auto const t(N - o);
+
+    return t < H || SKIP == load_(o) ? t : 0;
+  }
+
+  static constexpr size_type wrap_(size_type const o) noexcept
+  {
+    return N == o ? 0 : o;
+  }
+
+  bool msync_(size_type const o, size_type const n) const noexcept
+  { // msync() wants a page aligned address
+    static auto const ps(size_type(::sysconf(_SC_PAGESIZE)));
+
+    auto const b(PAGE + o), a(b / ps * ps);
+
+    return !::msync(m_ + a, b + n - a, MS_SYNC);
+  }
+
+  bool recover_() noexcept
+  {
+    header h[2];
+    std::memcpy(&h[0], m_, sizeof(header));
+    std::memcpy(&h[1], m_ + SLOT, sizeof(header));
+
+    auto const valid([](header const& e) noexcept
+      {
+        return (MAGIC == e.magic) && (CAP_BYTES == e.cap) && (e.f < N) &&
+          (e.l < N) && (crc_(e) == e.crc);
+      }
+    );
+
+    auto const v0(valid(h[0])), v1(valid(h[1]));
+
+    if (!v0 && !v1)
+    {
+      if (h[0].magic || h[1].magic) { errno = EINVAL; return false; }
+
+      return sync(); // a fresh file, crashed before its first header
+    }
+
+    auto const& b(!v1 || (v0 && (h[0].gen > h[1].gen)) ? h[0] : h[1]);
+
+    f_ = b.f; l_ = d_ = b.l; sf_ = b.sf; sl_ = b.sl; g_ = b.gen;
+
+    for (;;) // adopt records written after the last header update
+    {
+      auto const fr(CAP_BYTES - size());
+      auto const p(pad_(l_)), o(p ? 0 : l_);
+
+      if ((p + H > fr) || (N - o < H)) break;
+
+      auto const n(load_(o));
+
+      if ((n > fr - p - H) || (n > N - o - H) ||
+        (crc_(sl_, a_() + o + H, n) != load_(o + 4))) break;
+
+      l_ = wrap_(o + H + n); ++sl_;
+    }
+
+    w_ = l_ - d_ + (l_ < d_ ? size_type(N) : 0);
+
+    return true;
+  }
+
+public:
+  journal() = default;
+
+  journal(journal const&) = delete;
+  journal& operator=(journal const&) = delete;
+
+  ~journal() { close(); }
+
+  //
+  bool is_open() const noexcept { return m_; }
+
+  size_type size() const noexcept
+  {
+    return l_ - f_ + (l_ < f_ ? size_type(N) : 0);
+  }
+  bool empty() const noexcept { return f_ == l_; }
+
+  static constexpr size_type capacity() noexcept { return CAP_BYTES; }
+  static constexpr size_type max_record() noexcept { return CAP_BYTES - H; }
+
+  seq_type front_seq() const noexcept { return sf_; }
+  seq_type end_seq() const noexcept { return sl_; }
+
+  //
+  bool open(char const* const path) noexcept
+  { // creates or recovers, false on error (see errno)
+    close();
+
+    auto const fail([&]() noexcept
+      {
+        auto const e(errno); close(); errno = e; return false;
+      }
+    );
+
+    struct stat st;
+
+    if (((fd_ = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644)) < 0) ||
+      ::fstat(fd_, &st)) return fail();
+
+    if (auto const sz(PAGE + N); !st.st_size)
+    {
+      if (::ftruncate(fd_, sz)) return fail();
+    }
+    else if (size_type(st.st_size) != sz)
+    {
+      errno = EINVAL; return fail();
+    }
+
+    if (auto const p(::mmap({}, PAGE + N, PROT_READ | PROT_WRITE,
+      MAP_SHARED, fd_, 0)); MAP_FAILED == p)
+      return fail();
+    else
+      m_ = static_cast<std::byte*>(p);
+
+    f_ = l_ = d_ = w_ = {}; sf_ = sl_ = g_ = {};
+
+    return st.st_size ? recover_() || fail() : sync() || fail();
+  }
+
+  void close() noexcept
+  { // does not sync(), appended records survive a crash only if synced
+    if (m_) ::munmap(m_, PAGE + N), m_ = {};
+    if (fd_ >= 0) ::close(fd_), fd_ = -1;
+  }
+
+  bool sync() noexcept
+  { // batches every append() since the last sync(), then the header
+    if (w_ >= N)
+    {
+      if (!msync_(0, N)) return false;
+    }
+    else if (w_)
+    {
+      if (auto const t(N - d_); w_ > t)
+      {
+        if (!msync_(d_, t) || !msync_(0, w_ - t)) return false;
+      }
+      else if (!msync_(d_, w_)) return false;
+    }
+
+    d_ = l_; w_ = {};
+
+    header h{MAGIC, CAP_BYTES, ++g_, f_, l_, sf_, sl_, {}};
+    h.crc = crc_(h);
+
+    std::memcpy(m_ + g_ % 2 * SLOT, &h, sizeof(h)); // torn writes hit one
+
+    return !::msync(m_, PAGE, MS_SYNC);
+  }
+
+  //
+  bool append(const_span_type const s) noexcept
+  { // durable after the next sync()
+    auto const n(s.size());
+    auto const t(N - l_), fr(CAP_BYTES - size());
+    auto const p(t < H + n ? t : 0); // wrap to the start of the storage
+
+    if (p + H + n > fr) return false;
+
+    if (p >= H) store_(l_, SKIP);
+
+    auto const o(p ? 0 : l_);
+
+    store_(o, std::uint32_t(n));
+    store_(o + 4, crc_(sl_, s.data(), n));
+    if (n) std::memcpy(a_() + o + H, s.data(), n);
+
+    l_ = wrap_(o + H + n); ++sl_;
+    w_ += p + H + n;
+
+    return true;
+  }
+
+  const_span_type peek() const noexcept
+  { // the oldest record, data() is nullptr if there is none
+    if (empty()) return {};
+
+    auto const o(pad_(f_) ? 0 : f_);
+
+    return {a_() + o + H, load_(o)};
+  }
+
+  void consume() noexcept
+  { // the header catches up on the next sync()
+    auto const o(pad_(f_) ? 0 : f_);
+
+    f_ = wrap_(o + H + load_(o)); ++sf_;
+  }
+};
+
+}
+
+#endif // DQ_JOURNAL_HPP
@@ -0,0 +1,172 @@
+#ifndef DQ_LRU_HPP
+# define DQ_LRU_HPP
+# pragma once
+
+#include <functional> // std::hash
+
+#include "array.hpp"
+#include "index.hpp"
+
+namespace dq
+{
+
+template <typename Key, typename Value, std::size_t CAP,
+  enum Method M = MEMBER, typename H = std::hash<Key>>
+requires(std::is_default_constructible_v<Key> &&
+  std::is_default_constructible_v<Value>)
+class lru
+{ // fixed capacity, allocation free LRU cache
+public:
+  using key_type = Key;
+  using mapped_type = Value;
+  using size_type = std::size_t;
+
+//private:
+  using pos_t = std::conditional_t<(2 * CAP < UINT32_MAX), std::uint32_t,
+    size_type>;
+  using stamp_t = std::uint64_t; // never wraps, unlike a pos_t would
+
+  struct slot { Key k; Value v; stamp_t s; }; // s: stamp of the latest record
+  struct record { pos_t i; stamp_t s; };
+
+  // recency records, least recent first, a record is stale unless its
+  // stamp matches its slot's stamp; at most CAP records are live
+  array<record, 2 * CAP, M> r_;
+
+  array<slot, CAP, M> e_; // slots, never wraps, so e_[i] is stable
+  array<pos_t, CAP, M> u_; // unused slots
+  stamp_t t_{}; // stamp source
+
+  detail::index<CAP> x_; // key -> slot
+
+  constexpr auto find_(Key const& k) const noexcept(noexcept(H{}(k)))
+  {
+    return x_.find(H{}(k),
+      [&](auto const p) noexcept(noexcept(e_.front().k == k))
+      {
+        return e_[p].k == k;
+      }
+    );
+  }
+
+  constexpr void unlink_(Key const& k) noexcept(noexcept(find_(k)))
+  {
+    x_.erase(
+      find_(k),
+      [&](auto const p) noexcept(noexcept(H{}(k))) { return H{}(e_[p].k); }
+    );
+  }
+
+  constexpr bool live_(record const& r) const noexcept
+  {
+    return e_[r.i].s == r.s;
+  }
+
+  constexpr void touch_(pos_t const i) noexcept
+  {
+    if (r_.empty() || (r_.back().i != i) || !live_(r_.back()))
+    {
+      if (r_.full()) // drop the stale records, amortized O(1)
+        r_.resize(std::remove_if(r_.begin(), r_.end(),
+          [&](auto& r) noexcept { return !live_(r); }) - r_.begin());
+
+      r_.push_back(record{i, e_[i].s = ++t_});
+    }
+  }
+
+  constexpr pos_t alloc_() noexcept(noexcept(unlink_(e_.front().k)))
+  {
+    pos_t i;
+
+    if (!u_.empty())
+      i = u_.back(), u_.pop_back();
+    else if (!e_.full())
+      i = e_.size(), e_.resize(e_.size() + 1);
+    else
+    { // evict the least recently used slot
+      for (; !live_(r_.front()); r_.pop_front());
+
+      i = r_.front().i; r_.pop_front(); unlink_(e_[i].k);
+    }
+
+    return i;
+  }
+
+public:
+  lru() = default;
+
+  //
+  constexpr size_type size() const noexcept { return e_.size() - u_.size(); }
+  constexpr bool empty() const noexcept { return !size(); }
+  constexpr bool full() const noexcept { return CAP == size(); }
+
+  static constexpr size_type capacity() noexcept { return CAP; }
+
+  //
+  constexpr bool contains(Key const& k) const noexcept(noexcept(find_(k)))
+  {
+    return x_.used(find_(k));
+  }
+
+  constexpr Value* get(Key const& k) noexcept(noexcept(find_(k)))
+  { // marks k as most recently used
+    if (auto const i(find_(k)); x_.used(i))
+    {
+      auto const p(x_.pos(i)); touch_(p); return &e_[p].v;
+    }
+
+    return {};
+  }
+
+  constexpr Value const* peek(Key const& k) const
+    noexcept(noexcept(find_(k)))
+  { // does not change the recency order
+    auto const i(find_(k)); return x_.used(i) ? &e_[x_.pos(i)].v : nullptr;
+  }
+
+  constexpr Value& put(Key const& k, auto&& v)
+    noexcept(noexcept(alloc_(), e_.front().k = k,
+      e_.front().v = std::forward<decltype(v)>(v)))
+    requires(std::is_assignable_v<Value&, decltype(v)>)
+  { // inserts or assigns, evicts the least recently used entry when full
+    auto const i(find_(k));
+    pos_t p;
+
+    if (x_.used(i))
+      p = x_.pos(i);
+    else
+    {
+      e_[p = alloc_()].k = k;
+
+      x_.set(find_(k), p); // eviction may have shifted i
+    }
+
+    auto& s(e_[p]);
+    s.v = std::forward<decltype(v)>(v); touch_(p);
+
+    return s.v;
+  }
+
+  constexpr bool erase(Key const& k) noexcept(noexcept(unlink_(k)))
+  {
+    if (auto const i(find_(k)); x_.used(i))
+    {
+      auto const p(x_.pos(i));
+
+      unlink_(k); ++e_[p].s; u_.push_back(p); // stale records stay behind
+
+      return true;
+    }
+
+    return false;
+  }
+
+  constexpr void clear() noexcept
+  {
+    r_.clear(); e_.clear(); u_.clear(); x_.clear();
+  }
+};
+
+}
+
+#endif // DQ_LRU_HPP
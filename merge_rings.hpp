@@ -0,0 +1,156 @@
+#ifndef DQ_MERGE_RINGS_HPP
+# define DQ_MERGE_RINGS_HPP
+# pragma once
+
+#include <bit> // std::bit_ceil()
+#include <functional> // std::identity
+
+#include "array.hpp"
+
+namespace dq
+{
+
+namespace detail
+{
+
+template <typename T>
+constexpr auto sink(auto& out) noexcept
+{ // out is a container with push_back() or a callable taking a T
+  if constexpr(requires{out.push_back(std::declval<T const&>());})
+    return [&out](T const& v) noexcept(noexcept(out.push_back(v)))
+      {
+        out.push_back(v);
+      };
+  else
+    return [&out](T const& v) noexcept(noexcept(out(v)))
+      {
+        out(v);
+      };
+}
+
+constexpr std::size_t room(auto const& out, std::size_t const max) noexcept
+{ // a full ring would overwrite its oldest elements, so stop at capacity
+  if constexpr(requires{out.ca_array_tag; out.capacity() - out.size();})
+    return std::min(max, std::size_t(out.capacity() - out.size()));
+  else
+    return max;
+}
+
+}
+
+template <typename Ring, std::size_t K, typename P = std::identity>
+requires((K > 0) && requires{Ring::ca_array_tag;})
+class merge_rings
+{ // k-way merge of rings ordered by P(element), using a loser tree
+public:
+  using ring_type = Ring;
+  using value_type = typename Ring::value_type;
+  using size_type = std::size_t;
+
+//private:
+  enum : size_type { L = std::bit_ceil(K) }; // leaves
+
+  Ring* r_[K]; // sources
+  size_type n_{}; // number of sources
+  size_type c_[L]; // per source cursor, consumed but not yet popped
+  size_type t_[L]; // t_[0] is the winner, t_[1..L) the losers
+
+  template <bool D>
+  constexpr bool beats_(size_type const a, size_type const b) const
+    noexcept(noexcept(P{}(r_[0]->front()) < P{}(r_[0]->front())))
+  { // an exhausted source is +inf when draining (D), -inf otherwise
+    if (b >= n_) return true; else if (a >= n_) return false;
+
+    auto const ea(c_[a] == r_[a]->size()), eb(c_[b] == r_[b]->size());
+
+    if (ea || eb) return ea == eb ? a < b : D ? eb : ea;
+
+    auto&& ka(P{}((*r_[a])[c_[a]]));
+    auto&& kb(P{}((*r_[b])[c_[b]]));
+
+    return ka < kb ? true : kb < ka ? false : a < b; // stable
+  }
+
+  template <bool D>
+  constexpr void build_() noexcept(noexcept(beats_<D>(0, 0)))
+  {
+    size_type w[2 * L];
+
+    for (size_type i{}; i != L; ++i) c_[i] = {}, w[L + i] = i;
+
+    for (auto i(L - 1); i; --i)
+    {
+      auto const a(w[2 * i]), b(w[2 * i + 1]);
+
+      beats_<D>(a, b) ? (w[i] = a, t_[i] = b) : (w[i] = b, t_[i] = a);
+    }
+
+    t_[0] = w[1];
+  }
+
+  template <bool D>
+  constexpr void replay_(size_type w) noexcept(noexcept(beats_<D>(0, 0)))
+  {
+    for (auto i((w + L) / 2); i; i /= 2)
+      if (beats_<D>(t_[i], w)) std::swap(t_[i], w);
+
+    t_[0] = w;
+  }
+
+  template <bool D>
+  constexpr size_type run_(auto&& out, size_type const max)
+    noexcept(noexcept(beats_<D>(0, 0)) && noexcept(out(r_[0]->front())))
+  {
+    if (L == 1) t_[0] = c_[0] = {}; else build_<D>();
+
+    size_type m{};
+
+    for (size_type w; (m != max) && ((w = t_[0]) < n_) &&
+      (c_[w] != r_[w]->size()); ++m)
+    {
+      out(std::as_const((*r_[w])[c_[w]++]));
+
+      if constexpr(L != 1) replay_<D>(w);
+    }
+
+    for (size_type i{}; i != n_; ++i) r_[i]->pop_front(c_[i]); // bulk pop
+
+    return m;
+  }
+
+public:
+  merge_rings() = default;
+
+  constexpr merge_rings(std::initializer_list<Ring*> const l) noexcept
+  {
+    for (auto const r: l) add(*r);
+  }
+
+  //
+  constexpr size_type size() const noexcept { return n_; }
+
+  constexpr void add(Ring& r) noexcept { r_[n_++] = &r; } // n_ < K
+  constexpr void clear() noexcept { n_ = {}; }
+
+  //
+  constexpr size_type merge(auto&& out, size_type const max = -1)
+    noexcept(noexcept(run_<false>(detail::sink<value_type>(out),
+      detail::room(out, max))))
+  { // stops when a source runs dry, later input can still be ordered;
+    // a ring out is filled at most to capacity, returns elements written
+    return run_<false>(detail::sink<value_type>(out),
+      detail::room(out, max));
+  }
+
+  constexpr size_type drain(auto&& out, size_type const max = -1)
+    noexcept(noexcept(run_<true>(detail::sink<value_type>(out),
+      detail::room(out, max))))
+  { // merges everything buffered, e.g. at end of input
+    return run_<true>(detail::sink<value_type>(out),
+      detail::room(out, max));
+  }
+};
+
+}
+
+#endif // DQ_MERGE_RINGS_HPP
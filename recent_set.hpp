@@ -0,0 +1,120 @@
+#ifndef DQ_RECENT_SET_HPP
+# define DQ_RECENT_SET_HPP
+# pragma once
+
+#include <functional> // std::hash
+#include <memory> // std::addressof()
+
+#include "array.hpp"
+#include "index.hpp"
+
+namespace dq
+{
+
+template <typename Key, std::size_t CAP, enum Method M = MEMBER,
+  typename H = std::hash<Key>>
+class recent_set
+{ // the last CAP distinct keys, eviction in insertion order
+public:
+  using key_type = Key;
+  using size_type = std::size_t;
+
+//private:
+  array<Key, CAP, M> r_; // eviction order, elements never move
+  detail::index<CAP> x_; // key -> offset into r_.data()
+
+  constexpr auto find_(Key const& k) const noexcept(noexcept(H{}(k)))
+  {
+    return x_.find(H{}(k),
+      [&](auto const p) noexcept(noexcept(r_.front() == k))
+      {
+        return r_.data()[p] == k;
+      }
+    );
+  }
+
+  constexpr void evict_() noexcept(noexcept(find_(r_.front())))
+  {
+    x_.erase(
+      find_(r_.front()),
+      [&](auto const p) noexcept(noexcept(H{}(r_.front())))
+      {
+        return H{}(r_.data()[p]);
+      }
+    );
+
+    r_.pop_front();
+  }
+
+  constexpr void reindex_() noexcept(noexcept(find_(r_.front())))
+  { // copying or moving r_ may linearize it, invalidating the offsets
+    x_.clear();
+
+    for (auto& k: r_) x_.set(find_(k), std::addressof(k) - r_.data());
+  }
+
+public:
+  recent_set() = default;
+
+  constexpr recent_set(recent_set const& o)
+    noexcept(noexcept(Key(o.r_.front()), reindex_())):
+    r_(o.r_)
+  {
+    reindex_();
+  }
+
+  constexpr recent_set(recent_set&& o)
+    noexcept(noexcept(Key(std::move(o.r_.front())), reindex_())):
+    r_(std::move(o.r_))
+  {
+    reindex_(); o.clear();
+  }
+
+  constexpr recent_set& operator=(recent_set const& o)
+    noexcept(noexcept(Key(o.r_.front()), reindex_()))
+  {
+    if (this != &o) r_ = o.r_, reindex_();
+    return *this;
+  }
+
+  constexpr recent_set& operator=(recent_set&& o)
+    noexcept(noexcept(Key(std::move(o.r_.front())), reindex_()))
+  {
+    if (this != &o) r_ = std::move(o.r_), reindex_(), o.clear();
+    return *this;
+  }
+
+  //
+  constexpr auto& keys() const noexcept { return r_; }
+
+  constexpr auto size() const noexcept { return r_.size(); }
+  constexpr bool empty() const noexcept { return r_.empty(); }
+  constexpr bool full() const noexcept { return r_.full(); }
+
+  static constexpr size_type capacity() noexcept { return CAP; }
+
+  //
+  constexpr bool contains(Key const& k) const noexcept(noexcept(find_(k)))
+  {
+    return x_.used(find_(k));
+  }
+
+  constexpr void clear() noexcept { r_.clear(); x_.clear(); }
+
+  constexpr bool insert(Key const& k)
+    noexcept(noexcept(evict_(), r_.push_back(k)))
+  { // returns false if k was seen among the last CAP keys
+    auto i(find_(k));
+
+    if (x_.used(i)) return false;
+    else if (r_.full()) evict_(), i = find_(k); // the shift may move i
+
+    x_.set(i, r_.last() - r_.data()); r_.push_back(k);
+
+    return true;
+  }
+};
+
+}
+
+#endif // DQ_RECENT_SET_HPP
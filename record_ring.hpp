@@ -0,0 +1,128 @@
+#ifndef DQ_RECORD_RING_HPP
+# define DQ_RECORD_RING_HPP
+# pragma once
+
+#include <cstddef> // std::byte
+#include <span>
+
+#include "array.hpp"
+
+namespace dq
+{
+
+template <std::size_t CAP_BYTES, enum Method M = MEMBER>
+requires((CAP_BYTES > 4) && (CAP_BYTES - 4 < std::uint32_t(-1))) // < SKIP
+class record_ring
+{ // length prefixed, contiguous, variable length records in a byte ring
+public:
+  using size_type = std::size_t;
+  using span_type = std::span<std::byte>;
+  using const_span_type = std::span<std::byte const>;
+
+  enum : size_type { H = 4 }; // header, little endian record length
+
+//private:
+  enum : std::uint32_t { SKIP = std::uint32_t(-1) }; // wrap marker
+
+  array<std::byte, CAP_BYTES, M> r_;
+
+  size_type p_{}, n_{}; // reservation: padding before it, payload length
+
+  static constexpr std::uint32_t load_(std::byte const* const p) noexcept
+  {
+    std::uint32_t r{};
+
+    for (size_type i{}; i != H; ++i) r |= std::uint32_t(p[i]) << 8 * i;
+
+    return r;
+  }
+
+  static constexpr void store_(std::byte* const p,
+    std::uint32_t const v) noexcept
+  {
+    for (size_type i{}; i != H; ++i) p[i] = std::byte(v >> 8 * i);
+  }
+
+  constexpr auto end_() const noexcept { return r_.data() + (CAP_BYTES + 1); }
+
+  constexpr size_type pad_(std::byte const* const p) const noexcept
+  { // bytes to skip at p, the tail is skipped if it can not hold a record
+    auto const t(size_type(end_() - p));
+
+    return t < H || SKIP == load_(p) ? t : 0;
+  }
+
+public:
+  record_ring() = default;
+
+  //
+  constexpr size_type size() const noexcept { return r_.size(); }
+  constexpr bool empty() const noexcept { return r_.empty(); }
+
+  static constexpr size_type capacity() noexcept { return CAP_BYTES; }
+  static constexpr size_type max_record() noexcept { return CAP_BYTES - H; }
+
+  //
+  constexpr void clear() noexcept { r_.clear(); p_ = n_ = {}; }
+
+  constexpr span_type reserve(size_type const len) noexcept
+  { // contiguous room for len bytes, data() is nullptr if there is none
+    auto const l(r_.last());
+    auto const t(size_type(end_() - l)), f(CAP_BYTES - r_.size());
+
+    p_ = t < H + len ? t : 0; // wrap to the start of the storage
+
+    if (p_ + H + len > f) return {};
+
+    n_ = len;
+
+    return {(p_ ? r_.data() : l) + H, len};
+  }
+
+  constexpr void commit() noexcept { commit(n_); }
+
+  constexpr void commit(size_type const len) noexcept
+  { // publishes the first len (<= reserved) bytes of the reservation
+    auto const l(r_.last());
+
+    if (p_ >= H) store_(l, SKIP);
+
+    store_(p_ ? r_.data() : l, std::uint32_t(len));
+    r_.resize(r_.size() + p_ + H + len);
+
+    p_ = n_ = {};
+  }
+
+  constexpr bool push(const_span_type const s) noexcept
+  {
+    if (auto const r(reserve(s.size())); r.data())
+    {
+      std::ranges::copy(s, r.begin()); commit(); return true;
+    }
+
+    return false;
+  }
+
+  //
+  constexpr const_span_type peek() const noexcept
+  { // the oldest record, data() is nullptr if there is none
+    if (r_.empty()) return {};
+
+    auto f(r_.first());
+    if (pad_(f)) f = r_.data();
+
+    return {f + H, load_(f)};
+  }
+
+  constexpr void consume() noexcept
+  {
+    auto const f(r_.first());
+    auto const p(pad_(f));
+
+    r_.pop_front(p + H + load_(p ? r_.data() : f));
+  }
+};
+
+}
+
+#endif // DQ_RECORD_RING_HPP
@@ -0,0 +1,132 @@
+#ifndef DQ_RING2D_HPP
+# define DQ_RING2D_HPP
+# pragma once
+
+#include <span>
+#if __has_include(<mdspan>)
+# include <mdspan>
+#endif
+
+#include "array.hpp"
+
+namespace dq
+{
+
+template <typename T, std::size_t ROWS, std::size_t COLS,
+  enum Method M = MEMBER>
+requires(COLS > 0)
+class ring2d
+{ // the last ROWS rows of a stream, every row is contiguous
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using row_type = std::array<T, COLS>;
+
+  using span_type = std::span<T const>;
+  using row_span_type = std::span<T const, COLS>;
+
+  static_assert(sizeof(row_type) == COLS * sizeof(T));
+
+//private:
+  array<row_type, ROWS, M> r_; // rows are contiguous in the ring layout
+
+  constexpr std::array<span_type, 2> spans_(size_type const i,
+    size_type const j) const noexcept
+  { // logical rows [i, j) as at most two contiguous blocks
+    auto const s(r_.split());
+    auto const& [a, b](s[0]);
+    size_type const n(b - a);
+
+    auto const f([](row_type const* const p, size_type const k) noexcept
+      {
+        return k ? span_type(p->data(), k * COLS) : span_type();
+      }
+    );
+
+    return {
+      f(a + std::min(i, n), std::min(j, n) - std::min(i, n)),
+      f(s[1][0] + (std::max(i, n) - n), std::max(j, n) - std::max(i, n))
+    };
+  }
+
+public:
+  ring2d() = default;
+
+  //
+  constexpr auto size() const noexcept { return r_.size(); }
+  constexpr bool empty() const noexcept { return r_.empty(); }
+  constexpr bool full() const noexcept { return r_.full(); }
+
+  static constexpr size_type rows() noexcept { return ROWS; }
+  static constexpr size_type cols() noexcept { return COLS; }
+
+  //
+  constexpr row_span_type row(size_type const i) const noexcept
+  { // 0 is the oldest row
+    return row_span_type(r_[i]);
+  }
+
+  constexpr row_span_type back() const noexcept
+  {
+    return row_span_type(r_.back());
+  }
+
+  constexpr auto& operator()(size_type const i, size_type const j) noexcept
+  {
+    return r_[i][j];
+  }
+
+  constexpr auto& operator()(size_type const i,
+    size_type const j) const noexcept
+  {
+    return r_[i][j];
+  }
+
+  constexpr std::array<span_type, 2> window(size_type const k) const
+    noexcept
+  { // the last k rows (k <= size()), row major, at most two blocks
+    return spans_(r_.size() - k, r_.size());
+  }
+
+#if defined(__cpp_lib_mdspan)
+  using mdspan_type = std::mdspan<T const,
+    std::extents<size_type, std::dynamic_extent, COLS>>;
+
+  constexpr std::array<mdspan_type, 2> window_mdspan(size_type const k) const
+    noexcept
+  {
+    auto const w(window(k));
+
+    return {
+      mdspan_type(w[0].data(), w[0].size() / COLS),
+      mdspan_type(w[1].data(), w[1].size() / COLS)
+    };
+  }
+#endif // __cpp_lib_mdspan
+
+  //
+  constexpr void clear() noexcept { r_.clear(); }
+  constexpr void pop_front(size_type const n = 1) noexcept { r_.pop_front(n); }
+
+  constexpr std::span<T, COLS> prepare_row() noexcept
+  { // the row slot past the newest row, end() is always dereferencable
+    return std::span<T, COLS>(*r_.end());
+  }
+
+  constexpr void commit_row() noexcept
+  { // publishes the prepared row, rotates out the oldest row when full
+    if (r_.full()) r_.pop_front();
+
+    r_.resize(r_.size() + 1);
+  }
+
+  constexpr void push_row(std::span<T const, COLS> const r)
+    noexcept(std::is_nothrow_copy_assignable_v<T>)
+  {
+    std::ranges::copy(r, prepare_row().begin()); commit_row();
+  }
+};
+
+}
+
+#endif // DQ_RING2D_HPP
@@ -0,0 +1,333 @@
+#ifndef DQ_RING_VIEW_HPP
+# define DQ_RING_VIEW_HPP
+# pragma once
+
+#include "array.hpp"
+
+namespace dq
+{
+
+template <typename T, typename I = std::size_t>
+requires(
+  !std::is_reference_v<T> &&
+  !std::is_const_v<T> &&
+  std::is_unsigned_v<I> &&
+  (std::is_copy_assignable_v<T> || std::is_move_assignable_v<T>)
+)
+class ring_view
+{ // dq::array over a caller owned buffer of n slots (n - 1 elements), the
+  // head and tail live outside the view as slot indices
+public:
+  using value_type = T;
+
+  using difference_type = std::ptrdiff_t;
+  using size_type = std::size_t;
+  using reference = value_type&;
+  using const_reference = value_type const&;
+
+  using iterator = arrayiterator<T, ring_view>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_iterator = arrayiterator<T const, ring_view>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  enum {ca_array_tag};
+
+//private:
+  T* a_; // element array
+  difference_type n_; // slots in a_
+  I* h_, *t_; // indices of the first element and of the free slot
+
+  constexpr auto next_(auto const p) const noexcept
+  {
+    return p == a_ + (n_ - 1) ? decltype(p)(a_) : p + difference_type(1);
+  }
+
+  constexpr auto prev_(auto const p) const noexcept
+  {
+    return p == a_ ? decltype(p)(a_ + (n_ - 1)) : p - difference_type(1);
+  }
+
+  constexpr auto next_(auto const p, difference_type const n) const noexcept
+  { // 0 <= n < n_
+    return a_ + n_ - p > n ? p + n : p + (n - n_);
+  }
+
+  constexpr auto prev_(auto const p, difference_type const n) const noexcept
+  { // 0 <= n < n_
+    return p - a_ < n ? p + (n_ - n) : p - n;
+  }
+
+  constexpr auto adv_(auto const p, difference_type const n) const noexcept
+  { // -n_ < n < n_
+    return a_ + n_ - p <= n ? p + (n - n_) :
+      a_ - p > n ? p + (n_ + n) :
+      p + n;
+  }
+
+  constexpr auto bck_(auto const p, difference_type const n) const noexcept
+  { // -n_ < n < n_
+    return p - (a_ + n_) >= n ? p - (n + n_) :
+      p - a_ < n ? p + (n_ - n) :
+      p - n;
+  }
+
+  constexpr auto distance_(auto const a, decltype(a) b) const noexcept
+  {
+    auto const n(b - a);
+    return n < difference_type{} ? n_ + n : n;
+  }
+
+  constexpr void head_(T const* const p) const noexcept { *h_ = I(p - a_); }
+  constexpr void tail_(T const* const p) const noexcept { *t_ = I(p - a_); }
+
+public:
+  constexpr ring_view(T* const a, size_type const n, I& h, I& t) noexcept:
+    a_(a),
+    n_(n),
+    h_(&h),
+    t_(&t)
+  { // n >= 2, h and t < n
+  }
+
+  constexpr ring_view(std::span<T> const s, I& h, I& t) noexcept:
+    ring_view(s.data(), s.size(), h, t)
+  {
+  }
+
+  //
+  constexpr T* data() const noexcept { return a_; }
+  constexpr T* first() noexcept { return a_ + *h_; }
+  constexpr T const* first() const noexcept { return a_ + *h_; }
+  constexpr T* last() noexcept { return a_ + *t_; }
+  constexpr T const* last() const noexcept { return a_ + *t_; }
+
+  // iterators
+  constexpr iterator begin() noexcept { return {this, first()}; }
+  constexpr iterator end() noexcept { return {this, last()}; }
+
+  constexpr const_iterator begin() const noexcept { return {this, first()}; }
+  constexpr const_iterator end() const noexcept { return {this, last()}; }
+
+  constexpr auto cbegin() const noexcept { return begin(); }
+  constexpr auto cend() const noexcept { return end(); }
+
+  // reverse iterators
+  constexpr reverse_iterator rbegin() noexcept
+  {
+    return reverse_iterator{end()};
+  }
+
+  constexpr reverse_iterator rend() noexcept
+  {
+    return reverse_iterator{begin()};
+  }
+
+  constexpr const_reverse_iterator rbegin() const noexcept
+  {
+    return const_reverse_iterator{end()};
+  }
+
+  constexpr const_reverse_iterator rend() const noexcept
+  {
+    return const_reverse_iterator{begin()};
+  }
+
+  constexpr auto crbegin() const noexcept { return rbegin(); }
+  constexpr auto crend() const noexcept { return rend(); }
+
+  //
+  constexpr size_type capacity() const noexcept { return n_ - 1; }
+  static constexpr size_type max_size() noexcept { return PTRDIFF_MAX; }
+
+  constexpr bool empty() const noexcept { return *h_ == *t_; }
+  constexpr bool full() const noexcept { return next_(last()) == first(); }
+
+  constexpr size_type size() const noexcept
+  {
+    return distance_(first(), last());
+  }
+
+  //
+  constexpr auto& operator[](size_type const i) noexcept
+  {
+    return *next_(first(), i);
+  }
+
+  constexpr auto const& operator[](size_type const i) const noexcept
+  {
+    return *next_(first(), i);
+  }
+
+  constexpr auto& at(size_type const i) noexcept { return (*this)[i]; }
+  constexpr auto& at(size_type const i) const noexcept { return (*this)[i]; }
+
+  constexpr auto& back() noexcept { return *prev_(last()); }
+  constexpr auto const& back() const noexcept { return *prev_(last()); }
+
+  constexpr auto& front() noexcept { return *first(); }
+  constexpr auto const& front() const noexcept { return *first(); }
+
+  //
+  constexpr void clear() noexcept { *t_ = *h_; }
+  constexpr void resize(size_type const c) noexcept
+  {
+    tail_(next_(first(), c));
+  }
+
+  //
+  constexpr void pop_back() noexcept { tail_(prev_(last())); }
+  constexpr void pop_back(size_type const n) noexcept
+  {
+    tail_(prev_(last(), n));
+  }
+
+  constexpr void pop_front() noexcept { head_(next_(first())); }
+  constexpr void pop_front(size_type const n) noexcept
+  {
+    head_(next_(first(), n));
+  }
+
+  //
+  template <int = 0>
+  constexpr void push_back(auto&& a)
+    noexcept(std::is_nothrow_assignable_v<value_type&, decltype(a)>)
+    requires(std::is_assignable_v<value_type&, decltype(a)>)
+  {
+    auto const l(last());
+
+    *l = std::forward<decltype(a)>(a);
+    if (tail_(next_(l)); empty()) [[unlikely]] pop_front();
+  }
+
+  constexpr void push_back(auto&& ...a)
+    noexcept(noexcept((push_back<0>(std::forward<decltype(a)>(a)), ...)))
+    requires(sizeof...(a) > 1)
+  {
+    (push_back<0>(std::forward<decltype(a)>(a)), ...);
+  }
+
+  constexpr void push_back(value_type a)
+    noexcept(noexcept(push_back<0>(std::move(a))))
+  {
+    push_back<0>(std::move(a));
+  }
+
+  template <int = 0>
+  constexpr void push_front(auto&& a)
+    noexcept(std::is_nothrow_assignable_v<value_type&, decltype(a)>)
+    requires(std::is_assignable_v<value_type&, decltype(a)>)
+  { // pop_front() + push_front() = overwrite_front()
+    if (!full()) head_(prev_(first()));
+
+    *first() = std::forward<decltype(a)>(a);
+  }
+
+  constexpr void push_front(auto&& ...a)
+    noexcept(noexcept((push_front<0>(std::forward<decltype(a)>(a)), ...)))
+    requires(sizeof...(a) > 1)
+  {
+    (push_front<0>(std::forward<decltype(a)>(a)), ...);
+  }
+
+  constexpr void push_front(value_type a)
+    noexcept(noexcept(push_front<0>(std::move(a))))
+  {
+    push_front<0>(std::move(a));
+  }
+
+  //
+  constexpr auto append(T const* const p, size_type cnt) noexcept
+  { // appends to the view from a memory region
+    cnt = std::min(cnt, capacity() - size());
+
+    auto const f(first()), l(last());
+    auto const nc(std::min(size_type(f <= l ? a_ + n_ - l : f - l - 1), cnt));
+
+    std::copy_n(p, nc, l), std::copy_n(p + nc, cnt - nc, a_);
+
+    tail_(next_(l, cnt));
+
+    return cnt;
+  }
+
+  constexpr std::array<std::array<T*, 2>, 2> split() noexcept
+  {
+    using res_t = decltype(split());
+    using pair_t = res_t::value_type;
+
+    auto const f(first()), l(last());
+
+    return f <= l ? res_t{pair_t{f, l}} :
+      res_t{pair_t{f, a_ + n_}, pair_t{a_, l}};
+  }
+
+  constexpr std::array<std::array<T const*, 2>, 2> split() const noexcept
+  {
+    using res_t = decltype(split());
+    using pair_t = res_t::value_type;
+
+    auto const f(first()), l(last());
+
+    return f <= l ? res_t{pair_t{f, l}} :
+      res_t{pair_t{f, a_ + n_}, pair_t{a_, l}};
+  }
+
+  constexpr auto csplit() const noexcept { return split(); }
+
+  // producer/consumer access to the free and the filled region
+  constexpr std::array<std::span<T>, 2> prepare(size_type n) noexcept
+  { // up to n writable slots past the last element, see commit()
+    n = std::min(n, capacity() - size());
+
+    auto const l(last());
+    auto const c(std::min(n, size_type(a_ + n_ - l)));
+
+    return {std::span<T>(l, c), std::span<T>(a_, n - c)};
+  }
+
+  constexpr void commit(size_type const n) noexcept
+  { // publishes n (<= prepared) slots
+    tail_(next_(last(), n));
+  }
+
+  constexpr std::array<std::span<T>, 2> data_spans() noexcept
+  {
+    auto const s(split());
+
+    return {std::span<T>(s[0][0], s[0][1]), std::span<T>(s[1][0], s[1][1])};
+  }
+
+  constexpr std::array<std::span<T const>, 2> data_spans() const noexcept
+  {
+    auto const s(split());
+
+    return {std::span<T const>(s[0][0], s[0][1]),
+      std::span<T const>(s[1][0], s[1][1])};
+  }
+
+  constexpr void consume(size_type const n) noexcept { pop_front(n); }
+};
+
+//////////////////////////////////////////////////////////////////////////////
+template <typename T1, typename I1, typename T2, typename I2>
+constexpr bool operator==(ring_view<T1, I1> const& l,
+  ring_view<T2, I2> const& r)
+  noexcept(noexcept(std::equal(l.begin(), l.end(), r.begin(), r.end())))
+{
+  return std::equal(l.begin(), l.end(), r.begin(), r.end());
+}
+
+template <typename T, typename I>
+constexpr void copy(ring_view<T, I> const& a, T* p) noexcept
+{ // copies from the view to a memory region
+  for (auto const [i, j]: a.split())
+  {
+    if (i == j) break;
+
+    p = std::copy(i, j, p);
+  }
+}
+
+}
+
+#endif // DQ_RING_VIEW_HPP
@@ -0,0 +1,167 @@
+#ifndef DQ_ROLLING_HASH_HPP
+# define DQ_ROLLING_HASH_HPP
+# pragma once
+
+#include <cstddef> // std::byte
+#include <numeric> // std::transform_reduce()
+
+#include "array.hpp"
+
+namespace dq
+{
+
+template <typename T, std::size_t CAP, enum Method M = MEMBER,
+  auto E = std::execution::unseq>
+requires(std::is_integral_v<T> || std::is_same_v<T, std::byte>)
+class rolling_hash
+{ // Rabin-Karp hash of the last CAP values, modulo 2^64
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using hash_type = std::uint64_t;
+
+  static constexpr hash_type base{0x100000001b3u};
+
+//private:
+  enum : size_type { BLK = 256 }; // block update granularity
+
+  array<T, CAP, M, E> r_;
+  hash_type h_{};
+  hash_type q_{1}; // base^size(), so the window ops stay O(1)
+
+  static constexpr hash_type pow_(hash_type b, size_type e) noexcept
+  {
+    hash_type r(1);
+
+    for (; e; e >>= 1, b *= b) if (e & 1) r *= b;
+
+    return r;
+  }
+
+  static constexpr hash_type bw_{pow_(base, CAP)}; // evicts the oldest value
+
+  static constexpr hash_type bi_{ // base^-1, base is odd, Newton's method
+    []() noexcept
+    {
+      hash_type x(base);
+
+      for (int i{}; i != 5; ++i) x *= 2 - base * x;
+
+      return x;
+    }()
+  };
+
+  static_assert(1 == base * bi_);
+
+  // base powers in descending order, p_[BLK - 1 - k] = base^k
+  static constexpr auto p_{
+    []() noexcept
+    {
+      std::array<hash_type, BLK> p;
+
+      for (hash_type b(1); auto& e: p | std::views::reverse) e = b, b *= base;
+
+      return p;
+    }()
+  };
+
+  static constexpr auto v_(T const x) noexcept { return hash_type(x); }
+
+  static constexpr auto poly_(T const* const i, T const* const j) noexcept
+  { // hash of [i, j), j - i <= BLK
+    auto const p(p_.data() + (BLK - (j - i)));
+
+    constexpr auto f(
+      [](T const x, hash_type const b) noexcept { return v_(x) * b; });
+
+    if (std::is_constant_evaluated())
+      return std::transform_reduce(i, j, p, hash_type{}, std::plus(), f);
+    else
+      return std::transform_reduce(E, i, j, p, hash_type{}, std::plus(), f);
+  }
+
+  constexpr auto prefix_(size_type n) const noexcept
+  { // hash of the oldest n values, n <= BLK
+    hash_type r{};
+
+    for (auto const [i, j]: r_.split())
+    {
+      if (!n || (i == j)) break;
+
+      auto const c(std::min(size_type(j - i), n));
+
+      r = r * p_[BLK - c] * base + poly_(i, i + c); n -= c;
+    }
+
+    return r;
+  }
+
+public:
+  rolling_hash() = default;
+
+  //
+  constexpr hash_type hash() const noexcept { return h_; }
+  constexpr auto& window() const noexcept { return r_; }
+
+  constexpr auto size() const noexcept { return r_.size(); }
+  constexpr bool empty() const noexcept { return r_.empty(); }
+  constexpr bool full() const noexcept { return r_.full(); }
+
+  static constexpr size_type capacity() noexcept { return CAP; }
+
+  static constexpr hash_type hash_of(T const* p, size_type cnt) noexcept
+  { // hash of a linear memory region, for comparison with hash()
+    hash_type r{};
+
+    while (cnt)
+    {
+      auto const c(std::min(cnt, size_type(BLK)));
+
+      r = r * p_[BLK - c] * base + poly_(p, p + c); p += c; cnt -= c;
+    }
+
+    return r;
+  }
+
+  //
+  constexpr void clear() noexcept { r_.clear(); h_ = {}; q_ = 1; }
+
+  constexpr void pop_front() noexcept
+  {
+    h_ -= v_(r_.front()) * (q_ *= bi_); r_.pop_front();
+  }
+
+  constexpr void push_back(T const x) noexcept
+  {
+    if (r_.full())
+      h_ = h_ * base + v_(x) - v_(r_.front()) * bw_;
+    else
+      h_ = h_ * base + v_(x), q_ *= base;
+
+    r_.push_back(x);
+  }
+
+  constexpr void append(T const* p, size_type cnt) noexcept
+  { // block update, powers and dot products per BLK values
+    if (cnt >= CAP) clear(), p += cnt - CAP, cnt = CAP;
+
+    while (cnt)
+    {
+      auto const c(std::min(cnt, size_type(BLK)));
+      auto const s(r_.size() + c);
+      auto const e(s > CAP ? s - CAP : 0);
+
+      h_ = h_ * p_[BLK - c] * base + poly_(p, p + c) - prefix_(e) * bw_;
+
+      r_.pop_front(e); r_.append(p, c);
+
+      p += c; cnt -= c;
+    }
+
+    q_ = pow_(base, r_.size()); // once per call
+  }
+};
+
+}
+
+#endif // DQ_ROLLING_HASH_HPP
@@ -0,0 +1,145 @@
+#ifndef DQ_SEQ_ARRAY_HPP
+# define DQ_SEQ_ARRAY_HPP
+# pragma once
+
+#include "array.hpp"
+
+namespace dq
+{
+
+template <typename T, std::size_t CAP, enum Method M = MEMBER,
+  auto E = std::execution::unseq>
+class seq_array
+{ // a FIFO ring that numbers every element ever pushed, starting with 0
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using seq_type = std::uint64_t;
+
+  using span_type = std::span<T const>;
+
+  struct cursor
+  { // a reader position that survives overwrites
+    seq_type seq; // next element to read
+    seq_type lost; // elements overwritten before they were read
+  };
+
+//private:
+  array<T, CAP, M, E> r_;
+  seq_type s_{}; // sequence number of the front element
+
+public:
+  seq_array() = default;
+
+  //
+  constexpr auto& ring() const noexcept { return r_; }
+
+  constexpr auto size() const noexcept { return r_.size(); }
+  constexpr bool empty() const noexcept { return r_.empty(); }
+  constexpr bool full() const noexcept { return r_.full(); }
+
+  static constexpr size_type capacity() noexcept { return CAP; }
+
+  constexpr auto& front() const noexcept { return r_.front(); }
+  constexpr auto& back() const noexcept { return r_.back(); }
+
+  constexpr auto& operator[](size_type const i) const noexcept
+  {
+    return r_[i];
+  }
+
+  // sequence numbers
+  constexpr seq_type front_seq() const noexcept { return s_; }
+  constexpr seq_type end_seq() const noexcept { return s_ + r_.size(); }
+
+  constexpr seq_type seq_of(T const& e) const noexcept
+  { // e must be an element of the container
+    return s_ + r_.distance_(r_.first(), std::addressof(e));
+  }
+
+  constexpr T const* at_seq(seq_type const s) const noexcept
+  { // O(1), nullptr if s was overwritten or not pushed yet
+    return (s >= s_) && (s < end_seq()) ? &r_[s - s_] : nullptr;
+  }
+
+  // cursors
+  constexpr cursor oldest() const noexcept { return {s_, {}}; }
+  constexpr cursor newest() const noexcept { return {end_seq(), {}}; }
+
+  constexpr seq_type lag(cursor const& c) const noexcept
+  { // unread elements, including the ones already lost
+    return end_seq() - c.seq;
+  }
+
+  constexpr seq_type overrun(cursor const& c) const noexcept
+  { // elements that are gone before c could read them
+    return c.seq < s_ ? s_ - c.seq : 0;
+  }
+
+  constexpr T const* next(cursor& c) const noexcept
+  { // nullptr when caught up, skipped elements are added to c.lost
+    auto const o(overrun(c));
+    c.lost += o; c.seq += o;
+
+    return c.seq != end_seq() ? &r_[c.seq++ - s_] : nullptr;
+  }
+
+  constexpr std::array<span_type, 2> read(cursor& c,
+    size_type n = -1) const noexcept
+  { // up to n unread elements as spans, advances c past them
+    auto const o(overrun(c));
+    c.lost += o; c.seq += o;
+
+    auto const i(size_type(c.seq - s_));
+    n = std::min(n, r_.size() - i);
+    c.seq += n;
+
+    auto const d(r_.data_spans());
+    auto const l(d[0].size());
+
+    return {
+      d[0].subspan(std::min(i, l), std::min(i + n, l) - std::min(i, l)),
+      d[1].subspan(std::max(i, l) - l, std::max(i + n, l) - std::max(i, l))
+    };
+  }
+
+  //
+  constexpr void clear() noexcept { s_ += r_.size(); r_.clear(); }
+
+  constexpr void pop_front(size_type const n = 1) noexcept
+  {
+    s_ += n; r_.pop_front(n);
+  }
+
+  template <int = 0>
+  constexpr void push_back(auto&& a)
+    noexcept(noexcept(r_.push_back(std::forward<decltype(a)>(a))))
+  { // overwrites (and counts) the front element when full
+    s_ += r_.full(); r_.push_back(std::forward<decltype(a)>(a));
+  }
+
+  constexpr void push_back(auto&& ...a)
+    noexcept(noexcept((push_back<0>(std::forward<decltype(a)>(a)), ...)))
+    requires(sizeof...(a) > 1)
+  {
+    (push_back<0>(std::forward<decltype(a)>(a)), ...);
+  }
+
+  constexpr void push_back(value_type a)
+    noexcept(noexcept(push_back<0>(std::move(a))))
+  {
+    push_back<0>(std::move(a));
+  }
+
+  constexpr auto append(T const* const p, size_type const cnt) noexcept
+  { // never overwrites
+    return r_.append(p, cnt);
+  }
+
+  constexpr auto prepare(size_type const n) noexcept { return r_.prepare(n); }
+  constexpr void commit(size_type const n) noexcept { r_.commit(n); }
+};
+
+}
+
+#endif // DQ_SEQ_ARRAY_HPP
@@ -0,0 +1,145 @@
+#ifndef DQ_SEQLOCK_RING_HPP
+# define DQ_SEQLOCK_RING_HPP
+# pragma once
+
+#include <atomic>
+#include <cstring> // std::memcpy()
+
+#include "array.hpp"
+
+namespace dq
+{
+
+template <typename T, std::size_t CAP>
+requires(
+  std::is_trivially_copyable_v<T> &&
+  std::is_default_constructible_v<T> &&
+  (CAP > 0)
+)
+class seqlock_ring
+{ // one writer that never waits, any number of readers that copy the
+  // newest elements optimistically and retry if the writer tore them
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using seq_type = std::uint64_t;
+
+//private:
+  using word_t = std::uint64_t;
+
+  enum : size_type { W = (sizeof(T) + sizeof(word_t) - 1) / sizeof(word_t) };
+
+  struct slot
+  { // words, so that a racing copy is not undefined behaviour
+    std::atomic<word_t> w[W];
+  };
+
+  alignas(64) std::atomic<seq_type> b_{}; // writes begun
+  alignas(64) std::atomic<seq_type> c_{}; // writes committed
+
+  alignas(64) slot a_[CAP];
+
+  void store_(seq_type const p, T const& v) noexcept
+  {
+    word_t t[W]{};
+    std::memcpy(t, &v, sizeof(T));
+
+    for (auto& s(a_[p % CAP]); auto const i: std::views::iota(size_type{}, W))
+      s.w[i].store(t[i], std::memory_order_relaxed);
+  }
+
+  T load_(seq_type const p) const noexcept
+  {
+    word_t t[W];
+
+    for (auto& s(a_[p % CAP]); auto const i: std::views::iota(size_type{}, W))
+      t[i] = s.w[i].load(std::memory_order_relaxed);
+
+    T r; std::memcpy(&r, t, sizeof(T)); return r;
+  }
+
+public:
+  seqlock_ring() = default;
+
+  seqlock_ring(seqlock_ring const&) = delete;
+  seqlock_ring& operator=(seqlock_ring const&) = delete;
+
+  //
+  static constexpr size_type capacity() noexcept { return CAP; }
+
+  seq_type end_seq() const noexcept
+  { // elements ever pushed
+    return c_.load(std::memory_order_acquire);
+  }
+
+  size_type size() const noexcept
+  {
+    return std::min(end_seq(), seq_type(CAP));
+  }
+
+  bool empty() const noexcept { return !end_seq(); }
+
+  // the writer
+  void push_back(T const& v) noexcept
+  { // overwrites the oldest element when full
+    auto const p(c_.load(std::memory_order_relaxed));
+
+    b_.store(p + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    store_(p, v);
+
+    c_.store(p + 1, std::memory_order_release);
+  }
+
+  void append(T const* p, size_type n) noexcept
+  { // one begin/commit pair for the batch
+    if (n > CAP) p += n - CAP, n = CAP;
+
+    auto const c(c_.load(std::memory_order_relaxed));
+
+    b_.store(c + n, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_type i{}; i != n; ++i) store_(c + i, p[i]);
+
+    c_.store(c + n, std::memory_order_release);
+  }
+
+  // readers
+  size_type snapshot(T* const out, size_type n) const noexcept
+  { // the newest n (or fewer) elements, oldest first, returns their count
+    for (;;)
+    {
+      auto const c(c_.load(std::memory_order_acquire));
+      auto const f(c - std::min({seq_type(n), seq_type(CAP), c}));
+
+      for (auto i(f); i != c; ++i) out[i - f] = load_(i);
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+
+      // slot of f is overwritten once position f + CAP is begun
+      if (b_.load(std::memory_order_relaxed) <= f + CAP) return c - f;
+    }
+  }
+
+  bool back(T& v) const noexcept
+  { // the newest element, false if there is none
+    return snapshot(&v, 1);
+  }
+
+  template <std::size_t C = CAP, enum Method M = MEMBER>
+  array<T, C, M> snapshot() const
+  {
+    array<T, C, M> r;
+
+    auto const s(r.prepare(C)); // one span, r is fresh
+    r.commit(snapshot(s[0].data(), s[0].size()));
+
+    return r;
+  }
+};
+
+}
+
+#endif // DQ_SEQLOCK_RING_HPP
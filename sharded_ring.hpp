@@ -0,0 +1,218 @@
+#ifndef DQ_SHARDED_RING_HPP
+# define DQ_SHARDED_RING_HPP
+# pragma once
+
+#include <atomic>
+#include <memory> // std::unique_ptr
+
+#include "merge_rings.hpp"
+
+namespace dq
+{
+
+template <typename T, std::size_t CAP, std::size_t K = 16>
+requires(
+  std::is_default_constructible_v<T> &&
+  std::is_copy_assignable_v<T> &&
+  std::has_single_bit(CAP) &&
+  (K > 0)
+)
+class sharded_ring
+{ // one single producer ring per writer thread, so producers never contend,
+  // and one reader that drains or merges every shard in batches
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+//private:
+  enum : std::uint64_t { MASK = CAP - 1 };
+
+  // a shard is not a dq::array: its first and last pointers are plain
+  // members that both ends would write, while here the writer and the
+  // reader each own one atomic counter, and masking needs CAP = 2^n slots
+  struct shard
+  { // the writer and the reader sides live on separate cache lines
+    alignas(64) std::atomic<std::uint64_t> w{}; // published by the writer
+    std::uint64_t rc{}; // the writer's cached copy of r
+    std::atomic<bool> owned{};
+
+    alignas(64) std::atomic<std::uint64_t> r{}; // consumed by the reader
+
+    alignas(64) T a[CAP];
+  };
+
+  std::unique_ptr<shard[]> s_;
+
+  class view
+  { // what a shard has published so far, as a ring for merge_rings
+    shard* s_;
+    std::uint64_t r_, n_;
+
+  public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    enum {ca_array_tag};
+
+    view() = default;
+
+    explicit view(shard& s) noexcept:
+      s_(&s),
+      r_(s.r.load(std::memory_order_relaxed)),
+      n_(s.w.load(std::memory_order_acquire) - r_)
+    {
+    }
+
+    size_type size() const noexcept { return n_; }
+
+    auto& operator[](size_type const i) const noexcept
+    {
+      return std::as_const(s_->a[(r_ + i) & MASK]);
+    }
+
+    auto& front() const noexcept { return (*this)[0]; }
+
+    void pop_front(size_type const n) noexcept
+    { // hands the slots back to the writer
+      r_ += n; n_ -= n; s_->r.store(r_, std::memory_order_release);
+    }
+  };
+
+public:
+  class writer
+  { // exclusive access to one shard, released on destruction
+    friend class sharded_ring;
+
+    shard* s_{};
+
+    explicit writer(shard* const s) noexcept: s_(s) { }
+
+  public:
+    writer() = default;
+
+    writer(writer&& o) noexcept: s_(std::exchange(o.s_, {})) { }
+
+    writer& operator=(writer&& o) noexcept
+    {
+      if (this != &o) release(), s_ = std::exchange(o.s_, {});
+
+      return *this;
+    }
+
+    ~writer() { release(); }
+
+    //
+    explicit operator bool() const noexcept { return s_; }
+
+    void release() noexcept
+    {
+      if (s_) s_->owned.store(false, std::memory_order_release), s_ = {};
+    }
+
+    size_type free() noexcept
+    { // rereads the reader's position only when the cached one is short
+      auto const w(s_->w.load(std::memory_order_relaxed));
+
+      if (auto const f(CAP - (w - s_->rc)); f)
+        return f;
+      else
+        return CAP - (w - (s_->rc = s_->r.load(std::memory_order_acquire)));
+    }
+
+    bool push(auto&& v)
+      noexcept(std::is_nothrow_assignable_v<T&, decltype(v)>)
+      requires(std::is_assignable_v<T&, decltype(v)>)
+    { // false when the shard is full, nothing is overwritten
+      if (!free()) return false;
+
+      auto const w(s_->w.load(std::memory_order_relaxed));
+
+      s_->a[w & MASK] = std::forward<decltype(v)>(v);
+      s_->w.store(w + 1, std::memory_order_release);
+
+      return true;
+    }
+
+    size_type append(T const* const p, size_type n)
+      noexcept(std::is_nothrow_copy_assignable_v<T>)
+    { // one publish for the whole batch
+      n = std::min(n, free());
+
+      auto const w(s_->w.load(std::memory_order_relaxed));
+
+      for (size_type i{}; i != n; ++i) s_->a[(w + i) & MASK] = p[i];
+      s_->w.store(w + n, std::memory_order_release);
+
+      return n;
+    }
+  };
+
+  sharded_ring(): s_(new shard[K]) { }
+
+  sharded_ring(sharded_ring const&) = delete;
+  sharded_ring& operator=(sharded_ring const&) = delete;
+
+  //
+  static constexpr size_type shards() noexcept { return K; }
+  static constexpr size_type capacity() noexcept { return CAP; }
+
+  writer acquire() noexcept
+  { // a free shard, an empty writer if all K are taken
+    for (size_type i{}; i != K; ++i)
+      if (auto& s(s_[i]); !s.owned.load(std::memory_order_relaxed) &&
+        !s.owned.exchange(true, std::memory_order_acquire))
+        return writer(&s);
+
+    return {};
+  }
+
+  size_type size() const noexcept
+  { // everything published and not yet read, a snapshot
+    size_type n{};
+
+    for (size_type i{}; i != K; ++i)
+      n += s_[i].w.load(std::memory_order_acquire) -
+        s_[i].r.load(std::memory_order_relaxed);
+
+    return n;
+  }
+
+  bool empty() const noexcept { return !size(); }
+
+  // a single reader
+  size_type drain(auto&& out, size_type max = -1)
+  { // shard by shard, FIFO within a shard, no order between shards
+    auto const f(detail::sink<T>(out));
+    max = detail::room(out, max);
+
+    size_type m{};
+
+    for (size_type i{}; (i != K) && (m != max); ++i)
+    {
+      view v(s_[i]);
+
+      auto const n(std::min(v.size(), max - m));
+
+      for (size_type j{}; j != n; ++j) f(v[j]);
+
+      v.pop_front(n); m += n;
+    }
+
+    return m;
+  }
+
+  template <typename P = std::identity>
+  size_type merge(auto&& out, size_type const max = -1)
+  { // every published element, ordered by P(element) within this call
+    std::array<view, K> v;
+    merge_rings<view, K, P> m;
+
+    for (size_type i{}; i != K; ++i) m.add(v[i] = view(s_[i]));
+
+    return m.drain(std::forward<decltype(out)>(out), max);
+  }
+};
+
+}
+
+#endif // DQ_SHARDED_RING_HPP
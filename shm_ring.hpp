@@ -0,0 +1,255 @@
+#ifndef DQ_SHM_RING_HPP
+# define DQ_SHM_RING_HPP
+# pragma once
+
+#include <atomic>
+#include <cerrno> // errno
+#include <climits> // INT_MAX
+#include <new> // ::new
+
+#include <fcntl.h> // ::open()
+#include <linux/futex.h> // FUTEX_WAIT, FUTEX_WAKE
+#include <sys/file.h> // ::flock()
+#include <sys/mman.h> // ::memfd_create(), ::mmap()
+#include <sys/stat.h> // ::fstat()
+#include <sys/syscall.h> // SYS_futex
+#include <unistd.h> // ::close(), ::dup(), ::ftruncate(), ::syscall()
+
+#include "array.hpp"
+
+namespace dq
+{
+
+template <typename T, std::size_t CAP>
+requires(
+  std::is_trivially_copyable_v<T> &&
+  std::is_default_constructible_v<T> &&
+  std::has_single_bit(CAP) &&
+  std::atomic<std::uint64_t>::is_always_lock_free &&
+  std::atomic<std::uint32_t>::is_always_lock_free
+)
+class shm_ring
+{ // MPSC ring in shared memory, positions instead of pointers, so every
+  // process may map it at a different address
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+//private:
+  enum : std::uint64_t { MAGIC = 0x31304d4853515144, MASK = CAP - 1 };
+
+  struct cell
+  { // seq == pos + 1: published, seq == pos + CAP: free for the next lap
+    std::atomic<std::uint64_t> seq;
+    T v;
+  };
+
+  struct shared
+  {
+    std::atomic<std::uint64_t> magic; // stored last, once the rest is set
+    std::uint64_t cap, size;
+
+    alignas(64) std::atomic<std::uint64_t> t; // producers claim here
+    alignas(64) std::atomic<std::uint64_t> h; // the consumer reads here
+    std::atomic<std::uint32_t> w, ev; // consumer parked, wake futex word
+
+    alignas(64) cell c[CAP];
+  };
+
+  int fd_{-1};
+  shared* s_{};
+
+  static void futex_(std::atomic<std::uint32_t>& a, int const op,
+    std::uint32_t const v) noexcept
+  { // not FUTEX_PRIVATE_FLAG, the word is shared between processes
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&a), op, v,
+      nullptr, nullptr, 0);
+  }
+
+  bool map_(bool const init) noexcept
+  {
+    if (!init)
+    { // a short file would fault on access
+      if (struct stat st; ::fstat(fd_, &st))
+        return false;
+      else if (st.st_size < off_t(sizeof(shared)))
+      {
+        errno = EINVAL; return false;
+      }
+    }
+
+    if (auto const p(::mmap({}, sizeof(shared), PROT_READ | PROT_WRITE,
+      MAP_SHARED, fd_, 0)); MAP_FAILED == p)
+      return false;
+    else
+      s_ = static_cast<shared*>(p);
+
+    if (init)
+    { // the cells first, an attacher that sees MAGIC sees them too
+      ::new (s_) shared{{}, CAP, sizeof(shared), {}, {}, {}, {}, {}};
+
+      for (std::uint64_t i{}; i != CAP; ++i)
+        s_->c[i].seq.store(i, std::memory_order_relaxed);
+
+      s_->magic.store(MAGIC, std::memory_order_release);
+    }
+    else if ((MAGIC != s_->magic.load(std::memory_order_acquire)) ||
+      (CAP != s_->cap) || (sizeof(shared) != s_->size))
+    {
+      errno = EINVAL; return false;
+    }
+
+    return true;
+  }
+
+  bool setup_(bool const init) noexcept
+  {
+    if ((init && ::ftruncate(fd_, sizeof(shared))) || !map_(init))
+    {
+      auto const e(errno); close(); errno = e; return false;
+    }
+
+    return true;
+  }
+
+public:
+  shm_ring() = default;
+
+  shm_ring(shm_ring const&) = delete;
+  shm_ring& operator=(shm_ring const&) = delete;
+
+  ~shm_ring() { close(); }
+
+  //
+  bool create(char const* const name) noexcept
+  { // an anonymous memfd, hand fd() to other processes to attach()
+    close();
+
+    return (fd_ = ::memfd_create(name, MFD_CLOEXEC)) >= 0 && setup_(true);
+  }
+
+  bool open(char const* const path) noexcept
+  { // a named file, e.g. under /dev/shm, created if empty; the file lock
+    // keeps a second opener out until the first has initialized it
+    close();
+
+    struct stat st;
+
+    if (((fd_ = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600)) < 0) ||
+      ::flock(fd_, LOCK_EX) || ::fstat(fd_, &st))
+    {
+      auto const e(errno); close(); errno = e; return false;
+    }
+
+    auto const r(setup_(!st.st_size));
+
+    if (r) ::flock(fd_, LOCK_UN); // close() drops it otherwise
+
+    return r;
+  }
+
+  bool attach(int const fd) noexcept
+  { // maps an existing ring, fd is dup()ed
+    close();
+
+    return (fd_ = ::dup(fd)) >= 0 && setup_(false);
+  }
+
+  void close() noexcept
+  {
+    if (s_) ::munmap(s_, sizeof(shared)), s_ = {};
+    if (fd_ >= 0) ::close(fd_), fd_ = -1;
+  }
+
+  int fd() const noexcept { return fd_; }
+
+  //
+  static constexpr size_type capacity() noexcept { return CAP; }
+
+  size_type size() const noexcept
+  { // approximate while producers are running
+    auto const h(s_->h.load(std::memory_order_acquire));
+
+    return s_->t.load(std::memory_order_acquire) - h;
+  }
+
+  bool empty() const noexcept { return !size(); }
+
+  //
+  bool try_push(T const& v) noexcept
+  { // any number of producers, in any number of processes
+    auto t(s_->t.load(std::memory_order_relaxed));
+
+    for (;;)
+    {
+      auto& c(s_->c[t & MASK]);
+
+      if (auto const d(std::int64_t(c.seq.load(std::memory_order_acquire) -
+        t)); !d)
+      {
+        if (s_->t.compare_exchange_weak(t, t + 1, std::memory_order_relaxed))
+        {
+          c.v = v;
+          c.seq.store(t + 1, std::memory_order_release);
+
+          break;
+        }
+      }
+      else if (d < 0)
+        return false; // full
+      else
+        t = s_->t.load(std::memory_order_relaxed);
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with pop_wait
+
+    if (s_->w.load(std::memory_order_relaxed)) // elided if nobody is parked
+    {
+      s_->ev.fetch_add(1, std::memory_order_relaxed);
+      futex_(s_->ev, FUTEX_WAKE, INT_MAX);
+    }
+
+    return true;
+  }
+
+  bool try_pop(T& v) noexcept
+  { // a single consumer
+    auto const h(s_->h.load(std::memory_order_relaxed));
+    auto& c(s_->c[h & MASK]);
+
+    if (c.seq.load(std::memory_order_acquire) != h + 1) return false;
+
+    v = c.v;
+    c.seq.store(h + CAP, std::memory_order_release);
+    s_->h.store(h + 1, std::memory_order_release);
+
+    return true;
+  }
+
+  void pop_wait(T& v, unsigned spin = 128) noexcept
+  { // spins, then parks on a futex until a producer wakes it
+    for (;; --spin)
+    {
+      if (try_pop(v)) return;
+      else if (!spin) break;
+    }
+
+    for (;;)
+    {
+      s_->w.store(1, std::memory_order_relaxed);
+      auto const e(s_->ev.load(std::memory_order_relaxed));
+
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      if (try_pop(v)) break;
+
+      futex_(s_->ev, FUTEX_WAIT, e);
+    }
+
+    s_->w.store(0, std::memory_order_relaxed);
+  }
+};
+
+}
+
+#endif // DQ_SHM_RING_HPP
@@ -0,0 +1,163 @@
+#ifndef DQ_SPSC_RING_HPP
+# define DQ_SPSC_RING_HPP
+# pragma once
+
+#include <memory> // std::unique_ptr
+#include <optional>
+
+#include "array.hpp"
+#include "wait.hpp"
+
+namespace dq
+{
+
+template <typename T, std::size_t CAP, enum Method M = MEMBER>
+requires(
+  std::is_default_constructible_v<T> &&
+  (std::is_copy_assignable_v<T> || std::is_move_assignable_v<T>) &&
+  std::has_single_bit(CAP)
+)
+class spsc_ring
+{ // one producer, one consumer, both may block: they spin briefly, then
+  // yield, then sleep, and only a sleeping side gets notified
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+//private:
+  enum : std::uint64_t { MASK = CAP - 1 };
+
+  alignas(64) std::atomic<std::uint64_t> t_{}; // the producer's position
+  std::uint64_t hc_{}; // the producer's cached copy of h_
+
+  alignas(64) std::atomic<std::uint64_t> h_{}; // the consumer's position
+  std::uint64_t tc_{}; // the consumer's cached copy of t_
+
+  alignas(64) std::atomic<unsigned> wp_{}, wc_{}; // sleepers, rarely written
+
+  alignas(64) std::conditional_t<MEMBER == M, T[CAP], std::unique_ptr<T[]>>
+    a_;
+
+  bool can_push_() noexcept
+  {
+    auto const t(t_.load(std::memory_order_relaxed));
+
+    return (t - hc_ != CAP) ||
+      (t - (hc_ = h_.load(std::memory_order_acquire)) != CAP);
+  }
+
+  bool can_pop_() noexcept
+  {
+    auto const h(h_.load(std::memory_order_relaxed));
+
+    return (h != tc_) || (h != (tc_ = t_.load(std::memory_order_acquire)));
+  }
+
+  void push_(auto&& v)
+    noexcept(std::is_nothrow_assignable_v<T&, decltype(v)>)
+  { // can_push_() was true
+    auto const t(t_.load(std::memory_order_relaxed));
+
+    a_[t & MASK] = std::forward<decltype(v)>(v);
+    t_.store(t + 1, std::memory_order_release);
+
+    detail::unpark(t_, wc_);
+  }
+
+  T pop_() noexcept(std::is_nothrow_move_constructible_v<T>)
+  { // can_pop_() was true
+    auto const h(h_.load(std::memory_order_relaxed));
+
+    T r(std::move(a_[h & MASK]));
+    h_.store(h + 1, std::memory_order_release);
+
+    detail::unpark(h_, wp_);
+
+    return r;
+  }
+
+public:
+  spsc_ring() requires(MEMBER == M) = default;
+  spsc_ring() requires(NEW == M): a_(new T[CAP]) { }
+
+  spsc_ring(spsc_ring const&) = delete;
+  spsc_ring& operator=(spsc_ring const&) = delete;
+
+  //
+  static constexpr size_type capacity() noexcept { return CAP; }
+
+  size_type size() const noexcept
+  { // a snapshot
+    auto const h(h_.load(std::memory_order_acquire));
+
+    return t_.load(std::memory_order_acquire) - h;
+  }
+
+  bool empty() const noexcept { return !size(); }
+
+  // the producer
+  bool try_push(auto&& v)
+    noexcept(std::is_nothrow_assignable_v<T&, decltype(v)>)
+    requires(std::is_assignable_v<T&, decltype(v)>)
+  {
+    return can_push_() && (push_(std::forward<decltype(v)>(v)), true);
+  }
+
+  void push_wait(auto&& v)
+    noexcept(std::is_nothrow_assignable_v<T&, decltype(v)>)
+    requires(std::is_assignable_v<T&, decltype(v)>)
+  {
+    detail::park(h_, wp_, [&]() noexcept { return can_push_(); });
+
+    push_(std::forward<decltype(v)>(v));
+  }
+
+  template <typename C, typename D>
+  bool push_wait_until(auto&& v, std::chrono::time_point<C, D> const& t)
+    requires(std::is_assignable_v<T&, decltype(v)>)
+  {
+    return detail::park_until(h_, wp_, t,
+      [&]() noexcept { return can_push_(); }) &&
+      (push_(std::forward<decltype(v)>(v)), true);
+  }
+
+  template <typename R, typename P>
+  bool push_wait_for(auto&& v, std::chrono::duration<R, P> const& d)
+    requires(std::is_assignable_v<T&, decltype(v)>)
+  {
+    return push_wait_until(std::forward<decltype(v)>(v),
+      std::chrono::steady_clock::now() + d);
+  }
+
+  // the consumer
+  std::optional<T> try_pop()
+    noexcept(std::is_nothrow_move_constructible_v<T>)
+  {
+    return can_pop_() ? std::optional<T>(pop_()) : std::nullopt;
+  }
+
+  T pop_wait() noexcept(std::is_nothrow_move_constructible_v<T>)
+  {
+    detail::park(t_, wc_, [&]() noexcept { return can_pop_(); });
+
+    return pop_();
+  }
+
+  template <typename C, typename D>
+  std::optional<T> pop_wait_until(std::chrono::time_point<C, D> const& t)
+  {
+    return detail::park_until(t_, wc_, t,
+      [&]() noexcept { return can_pop_(); }) ?
+      std::optional<T>(pop_()) : std::nullopt;
+  }
+
+  template <typename R, typename P>
+  std::optional<T> pop_wait_for(std::chrono::duration<R, P> const& d)
+  {
+    return pop_wait_until(std::chrono::steady_clock::now() + d);
+  }
+};
+
+}
+
+#endif // DQ_SPSC_RING_HPP
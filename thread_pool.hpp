@@ -0,0 +1,172 @@
+#ifndef DQ_THREAD_POOL_HPP
+# define DQ_THREAD_POOL_HPP
+# pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional> // std::function
+#include <mutex>
+#include <random> // std::minstd_rand
+#include <thread>
+
+#include "ws_deque.hpp"
+
+namespace dq
+{
+
+template <std::size_t CAP = 1024>
+class thread_pool
+{ // a work-stealing executor, one dq::ws_deque per worker
+public:
+  using size_type = std::size_t;
+  using task = std::function<void()>;
+
+//private:
+  struct alignas(64) worker
+  {
+    ws_deque<task*, CAP, NEW> q;
+    std::thread t;
+  };
+
+  size_type const n_;
+  std::unique_ptr<worker[]> w_;
+
+  std::mutex m_;
+  std::condition_variable cw_, ci_; // workers, wait_idle()
+
+  std::deque<task*> i_; // tasks from outside the pool
+  std::atomic<size_type> ni_{}, p_{}; // injected, pending
+  std::atomic<unsigned> s_{}; // sleeping workers
+  bool stop_{};
+
+  static inline thread_local thread_pool* pool_{};
+  static inline thread_local size_type id_{};
+
+  bool any_() const noexcept
+  {
+    return ni_.load(std::memory_order_relaxed) ||
+      std::any_of(w_.get(), w_.get() + n_, [](auto const& w) noexcept
+        { return !w.q.empty(); });
+  }
+
+  task* find_(size_type const i, std::minstd_rand& r)
+  {
+    auto& q(w_[i].q);
+
+    if (auto const t(q.pop()); t) return *t;
+
+    if (ni_.load(std::memory_order_relaxed))
+    {
+      std::lock_guard l(m_);
+
+      if (!i_.empty())
+      {
+        auto const t(i_.front()); i_.pop_front(); --ni_; return t;
+      }
+    }
+
+    for (size_type k(n_), v(r()); k; --k) // victims, from a random one
+    {
+      task* t{};
+
+      if (v = (v + 1) % n_; v != i)
+        w_[v].q.steal_half([&](task* const s)
+          { // keep the oldest, queue the rest
+            if (t) q.push(s); else t = s;
+          }
+        );
+
+      if (t) return t;
+    }
+
+    return {};
+  }
+
+  void run_(size_type const i)
+  {
+    pool_ = this; id_ = i;
+
+    for (std::minstd_rand r(i + 1);;)
+    {
+      if (auto const t(find_(i, r)); t)
+      {
+        (*t)(); delete t;
+
+        if (1 == p_.fetch_sub(1, std::memory_order_acq_rel))
+        {
+          std::lock_guard l(m_); ci_.notify_all();
+        }
+      }
+      else
+      {
+        std::unique_lock l(m_);
+
+        s_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst); // see submit()
+
+        cw_.wait(l, [&]() noexcept { return stop_ || any_(); });
+
+        s_.fetch_sub(1, std::memory_order_relaxed);
+
+        if (stop_ && !any_()) break;
+      }
+    }
+  }
+
+public:
+  explicit thread_pool(size_type const n = std::thread::hardware_concurrency()):
+    n_(std::max(n, size_type(1))),
+    w_(new worker[n_])
+  {
+    for (size_type i{}; i != n_; ++i)
+      w_[i].t = std::thread(&thread_pool::run_, this, i);
+  }
+
+  thread_pool(thread_pool const&) = delete;
+  thread_pool& operator=(thread_pool const&) = delete;
+
+  ~thread_pool()
+  {
+    wait_idle();
+
+    { std::lock_guard l(m_); stop_ = true; }
+
+    cw_.notify_all();
+
+    for (size_type i{}; i != n_; ++i) w_[i].t.join();
+  }
+
+  //
+  size_type size() const noexcept { return n_; }
+
+  void submit(auto&& f)
+  { // workers push to their own deque, other threads to a shared queue
+    auto const t(new task(std::forward<decltype(f)>(f)));
+
+    p_.fetch_add(1, std::memory_order_relaxed);
+
+    if (this == pool_)
+      w_[id_].q.push(t);
+    else
+    {
+      std::lock_guard l(m_); i_.push_back(t); ++ni_;
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst); // see run_()
+
+    if (s_.load(std::memory_order_relaxed))
+    {
+      std::lock_guard l(m_); cw_.notify_one();
+    }
+  }
+
+  void wait_idle()
+  { // until every submitted task has run, not from inside a task
+    std::unique_lock l(m_);
+    ci_.wait(l, [&]() noexcept { return !p_.load(); });
+  }
+};
+
+}
+
+#endif // DQ_THREAD_POOL_HPP
@@ -0,0 +1,117 @@
+#ifndef DQ_TIME_RING_HPP
+# define DQ_TIME_RING_HPP
+# pragma once
+
+#include <functional> // std::identity
+#include <span>
+
+#include "array.hpp"
+
+namespace dq
+{
+
+template <typename T, std::size_t CAP, typename P = std::identity,
+  enum Method M = MEMBER, auto E = std::execution::unseq>
+requires(std::is_invocable_v<P, T const&>)
+class time_ring
+{ // elements in arrival order, P(element) must be non-decreasing
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using time_type = std::remove_cvref_t<std::invoke_result_t<P, T const&>>;
+  using span_type = std::span<T const>;
+
+//private:
+  array<T, CAP, M, E> r_;
+
+  constexpr size_type lower_bound_(time_type const& t) const
+    noexcept(noexcept(P{}(r_.front()) < t))
+  { // binary search the older segment only if it can hold t
+    auto const s(r_.split());
+    auto const f(
+      [&](T const* const i, T const* const j) noexcept(noexcept(
+        P{}(*i) < t))
+      {
+        return std::ranges::lower_bound(i, j, t, {}, P{}) - i;
+      }
+    );
+
+    auto const& [i, j](s[0]);
+    auto const n(j - i);
+
+    return !n || !(P{}(j[-1]) < t) ? f(i, j) : n + f(s[1][0], s[1][1]);
+  }
+
+  constexpr std::array<span_type, 2> spans_(size_type const i,
+    size_type const j) const noexcept
+  { // logical [i, j) as at most two spans
+    auto const s(r_.split());
+    auto const& [a, b](s[0]);
+    size_type const n(b - a);
+
+    return {
+      span_type(a + std::min(i, n), a + std::min(j, n)),
+      span_type(s[1][0] + (std::max(i, n) - n), s[1][0] + (std::max(j, n) - n))
+    };
+  }
+
+public:
+  time_ring() = default;
+
+  //
+  constexpr auto& ring() const noexcept { return r_; }
+
+  constexpr auto size() const noexcept { return r_.size(); }
+  constexpr bool empty() const noexcept { return r_.empty(); }
+  constexpr bool full() const noexcept { return r_.full(); }
+
+  static constexpr size_type capacity() noexcept { return CAP; }
+
+  constexpr auto& front() const noexcept { return r_.front(); }
+  constexpr auto& back() const noexcept { return r_.back(); }
+
+  //
+  constexpr size_type lower_bound(time_type const& t) const
+    noexcept(noexcept(lower_bound_(t)))
+  { // number of elements older than t
+    return lower_bound_(t);
+  }
+
+  constexpr std::array<span_type, 2> range(time_type const& t0,
+    time_type const& t1) const noexcept(noexcept(lower_bound_(t0)))
+  { // elements with t0 <= time < t1, no copies
+    auto const i(lower_bound_(t0));
+
+    return spans_(i, std::max(i, lower_bound_(t1)));
+  }
+
+  constexpr std::array<span_type, 2> spans() const noexcept
+  {
+    return spans_(0, r_.size());
+  }
+
+  //
+  constexpr void clear() noexcept { r_.clear(); }
+
+  constexpr size_type evict_older_than(time_type const& t)
+    noexcept(noexcept(lower_bound_(t)))
+  { // bulk pop of every element with time < t
+    auto const n(lower_bound_(t)); r_.pop_front(n); return n;
+  }
+
+  constexpr void pop_front(size_type const n = 1) noexcept
+  {
+    r_.pop_front(n);
+  }
+
+  constexpr void push_back(auto&& ...a)
+    noexcept(noexcept(r_.push_back(std::forward<decltype(a)>(a)...)))
+    requires(!!sizeof...(a))
+  { // overwrites the oldest element when full
+    r_.push_back(std::forward<decltype(a)>(a)...);
+  }
+};
+
+}
+
+#endif // DQ_TIME_RING_HPP
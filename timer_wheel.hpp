@@ -0,0 +1,217 @@
+#ifndef DQ_TIMER_WHEEL_HPP
+# define DQ_TIMER_WHEEL_HPP
+# pragma once
+
+#include <bit> // std::has_single_bit()
+
+#include "array.hpp"
+
+namespace dq
+{
+
+template <typename T, std::size_t CAP, std::size_t BUCKET = 64,
+  std::size_t SLOTS = 64, std::size_t LV = 4, enum Method M = MEMBER>
+requires(std::has_single_bit(SLOTS) && (SLOTS > 1) && (LV > 0) &&
+  (LV * std::countr_zero(SLOTS) < 64))
+class timer_wheel
+{ // hierarchical timer wheel, LV levels of SLOTS buckets of BUCKET timers
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using tick_type = std::uint64_t;
+
+  using pos_t = std::conditional_t<(CAP < UINT32_MAX), std::uint32_t,
+    size_type>;
+
+  struct handle { pos_t i, g; };
+
+  static constexpr handle invalid{pos_t(-1), {}};
+
+//private:
+  enum : unsigned { BITS = std::countr_zero(SLOTS) };
+  enum : pos_t { DETACHED = pos_t(-1) };
+
+  struct timer { tick_type d; T v; pos_t b, p, g; }; // bucket, position
+
+  array<timer, CAP, M> t_; // pool, never wraps, so t_[i] is stable
+  array<pos_t, CAP, M> u_; // unused timers
+  array<pos_t, BUCKET, M> w_[LV * SLOTS]; // level major buckets
+
+  tick_type now_{}; // last processed tick
+
+  constexpr size_type bucket_(tick_type d) const noexcept
+  { // an overdue timer goes to the current level 0 bucket
+    auto const dt((d = std::max(d, now_)) - now_);
+
+    size_type l{};
+    for (; (l + 1 != LV) && (dt >> (BITS * (l + 1))); ++l);
+
+    auto const s(dt >> (BITS * (l + 1)) ? // beyond the top level
+      now_ + ((tick_type(1) << (BITS * LV)) - 1) : d);
+
+    return l * SLOTS + ((s >> (BITS * l)) & (SLOTS - 1));
+  }
+
+  constexpr bool link_(pos_t const i) noexcept
+  {
+    auto& t(t_[i]);
+    auto const b(bucket_(t.d));
+
+    if (auto& w(w_[b]); w.full()) return false;
+    else t.b = b, t.p = w.size(), w.push_back(i);
+
+    return true;
+  }
+
+  constexpr void unlink_(pos_t const i) noexcept
+  { // swap with the last timer of the bucket
+    auto const& t(t_[i]);
+    auto& w(w_[t.b]);
+
+    t_[w[t.p] = w.back()].p = t.p; w.pop_back();
+  }
+
+  constexpr void put_(pos_t const i, size_type const b) noexcept
+  {
+    auto& w(w_[b]);
+    t_[i].b = b; t_[i].p = w.size(); w.push_back(i);
+  }
+
+  constexpr bool hold_(pos_t const i, size_type const b) noexcept
+  { // bucket_(d) is full: park the timer in the bucket cascaded last at
+    // or before d, where it is placed again, else postpone it to the
+    // start of the next bucket with room, that is by less than SLOTS
+    // ticks per full level 0 or 1 bucket skipped
+    auto& t(t_[i]);
+    auto d(std::max(t.d, now_));
+
+    if (bucket_(d) >= SLOTS) // a level 0 bucket is never cascaded
+    {
+      size_type c(b);
+      tick_type m{};
+
+      for (size_type l(1); l != LV; ++l)
+      {
+        auto const u(tick_type(1) << (BITS * l)), p(u << BITS);
+
+        for (size_type s{}; s != SLOTS; ++s)
+          if (auto const k(l * SLOTS + s); (k != b) && !w_[k].full())
+          { // the next cascade of k
+            auto const n((now_ & ~(p - 1)) + s * u);
+
+            if (auto const e(n > now_ ? n : n + p); (e <= d) && (e > m))
+              m = e, c = k;
+          }
+      }
+
+      if (c != b) return put_(i, c), true;
+    }
+
+    for (;;)
+      if (auto const c(bucket_(d)); !w_[c].full())
+        return t.d = d, put_(i, c), true;
+      else if (auto const u(tick_type(1) << (BITS * (c / SLOTS)));
+        ((d = (d | (u - 1)) + 1) - now_) >> (BITS * LV))
+        return false; // beyond the top level
+  }
+
+  constexpr void cascade_(size_type const b) noexcept
+  { // a timer that fits nowhere stays until the next cascade of b
+    auto& w(w_[b]);
+
+    for (auto j(w.size()); j;)
+      if (auto const i(w[--j]); bucket_(t_[i].d) != b)
+      {
+        unlink_(i);
+        if (!link_(i) && !hold_(i, b)) put_(i, b);
+      }
+  }
+
+public:
+  timer_wheel() = default;
+
+  //
+  constexpr tick_type now() const noexcept { return now_; }
+  constexpr size_type size() const noexcept { return t_.size() - u_.size(); }
+  constexpr bool empty() const noexcept { return !size(); }
+
+  static constexpr size_type capacity() noexcept { return CAP; }
+
+  //
+  constexpr handle schedule(tick_type d, auto&& v)
+    noexcept(noexcept(t_.front().v = std::forward<decltype(v)>(v)))
+    requires(std::is_assignable_v<T&, decltype(v)>)
+  { // fires on tick max(d, now() + 1), invalid if the pool or bucket is full
+    d = std::max(d, now_ + 1);
+
+    if (u_.empty() && t_.full()) return invalid;
+    else if (w_[bucket_(d)].full()) return invalid;
+
+    pos_t i;
+
+    if (u_.empty()) i = t_.size(), t_.resize(i + 1), t_[i].g = {};
+    else i = u_.back(), u_.pop_back();
+
+    auto& t(t_[i]);
+    t.d = d; t.v = std::forward<decltype(v)>(v); link_(i);
+
+    return {i, t.g};
+  }
+
+  constexpr handle schedule_in(tick_type const dt, auto&& v)
+    noexcept(noexcept(schedule(dt, std::forward<decltype(v)>(v))))
+  {
+    return schedule(now_ + dt, std::forward<decltype(v)>(v));
+  }
+
+  constexpr bool cancel(handle const h) noexcept
+  {
+    if ((h.i < t_.size()) && (t_[h.i].g == h.g) && (DETACHED != t_[h.i].b))
+    {
+      unlink_(h.i); ++t_[h.i].g; t_[h.i].b = DETACHED; u_.push_back(h.i);
+
+      return true;
+    }
+
+    return false;
+  }
+
+  constexpr size_type tick(auto&& f)
+    noexcept(noexcept(f(std::declval<T&>())))
+  { // advances one tick and fires its timers in one batch
+    ++now_;
+
+    for (auto l(LV - 1); l; --l) // cascade the higher levels first
+      if (!(now_ & ((tick_type(1) << (BITS * l)) - 1)))
+        cascade_(l * SLOTS + ((now_ >> (BITS * l)) & (SLOTS - 1)));
+
+    auto& w(w_[now_ & (SLOTS - 1)]);
+    array<pos_t, BUCKET> const b(w.begin(), w.end()); // detach the batch
+    w.clear();
+
+    for (auto const i: b) t_[i].b = DETACHED; // can no longer be cancelled
+
+    for (auto const i: b)
+    { // the callback may schedule or cancel other timers
+      T v(std::move(t_[i].v));
+
+      ++t_[i].g; u_.push_back(i); f(v);
+    }
+
+    return b.size();
+  }
+
+  constexpr size_type advance(tick_type const to, auto&& f)
+    noexcept(noexcept(tick(f)))
+  { // ticks up to and including to
+    size_type r{};
+
+    while (now_ < to) r += tick(f);
+
+    return r;
+  }
+};
+
+}
+
+#endif // DQ_TIMER_WHEEL_HPP
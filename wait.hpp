@@ -0,0 +1,145 @@
+#ifndef DQ_WAIT_HPP
+# define DQ_WAIT_HPP
+# pragma once
+
+#include <atomic>
+#include <bit> // std::endian
+#include <chrono>
+#include <climits> // INT_MAX
+#include <cstdint> // std::uint32_t
+#include <thread> // std::this_thread::yield()
+
+#if defined(__linux__)
+# include <linux/futex.h> // FUTEX_WAIT_PRIVATE, FUTEX_WAKE_PRIVATE
+# include <sys/syscall.h> // SYS_futex
+# include <unistd.h> // ::syscall()
+#endif
+
+namespace dq
+{
+
+namespace detail
+{
+
+inline void cpu_relax() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+enum : unsigned { SPIN = 128, YIELD = 16 };
+
+inline bool spin(auto const pred) noexcept(noexcept(pred()))
+{ // the low latency path: spins, then yields, true once pred() holds
+  for (unsigned i{}; i != SPIN; ++i)
+    if (pred()) return true; else cpu_relax();
+
+  for (unsigned i{}; i != YIELD; ++i)
+    if (pred()) return true; else std::this_thread::yield();
+
+  return pred();
+}
+
+inline void park(auto& a, std::atomic<unsigned>& w, auto const pred)
+  noexcept(noexcept(pred()))
+{ // spins, then sleeps on a until pred() holds, w counts the sleepers
+  if (spin(pred)) return;
+
+  w.fetch_add(1, std::memory_order_relaxed);
+
+  for (;;)
+  {
+    auto const v(a.load(std::memory_order_relaxed));
+
+    std::atomic_thread_fence(std::memory_order_seq_cst); // see unpark()
+
+    if (pred()) break;
+
+    a.wait(v, std::memory_order_relaxed);
+  }
+
+  w.fetch_sub(1, std::memory_order_relaxed);
+}
+
+#if defined(__linux__)
+inline auto futex_word(auto& a) noexcept
+{ // the low half of a, it changes whenever a does
+  static_assert((sizeof(a) == 4) || (sizeof(a) == 8));
+
+  return reinterpret_cast<std::uint32_t*>(&a) +
+    (std::endian::big == std::endian::native) * (sizeof(a) / 4 - 1);
+}
+#endif
+
+inline void unpark(auto& a, std::atomic<unsigned> const& w) noexcept
+{ // call after changing a, elided while nobody sleeps
+  std::atomic_thread_fence(std::memory_order_seq_cst); // see park()
+
+  if (w.load(std::memory_order_relaxed))
+  {
+    a.notify_all();
+#if defined(__linux__)
+    ::syscall(SYS_futex, futex_word(a), FUTEX_WAKE_PRIVATE, INT_MAX,
+      nullptr, nullptr, 0); // see park_until()
+#endif
+  }
+}
+
+template <typename C, typename D>
+bool park_until(auto& a, std::atomic<unsigned>& w,
+  std::chrono::time_point<C, D> const& t, auto const pred)
+  noexcept(noexcept(pred()))
+{ // like park(), but gives up at t; std::atomic::wait() has no timeout,
+  // so this sleeps on a futex on a, elsewhere it sleeps with backoff
+  if (spin(pred)) return true;
+
+#if defined(__linux__)
+  using namespace std::chrono;
+
+  w.fetch_add(1, std::memory_order_relaxed);
+
+  bool r;
+
+  for (;;)
+  {
+    auto const v(a.load(std::memory_order_relaxed));
+
+    std::atomic_thread_fence(std::memory_order_seq_cst); // see unpark()
+
+    if ((r = pred())) break;
+    else if (auto const now(C::now()); now >= t) break;
+    else
+    { // FUTEX_WAIT takes a relative timeout, woken early at most hourly
+      auto const d(ceil<nanoseconds>(std::min<duration<double>>(t - now,
+        hours(1))));
+      timespec const ts{time_t(d.count() / 1000000000),
+        long(d.count() % 1000000000)};
+
+      ::syscall(SYS_futex, futex_word(a), FUTEX_WAIT_PRIVATE,
+        std::uint32_t(v), &ts, nullptr, 0);
+    }
+  }
+
+  w.fetch_sub(1, std::memory_order_relaxed);
+
+  return r;
+#else
+  for (std::chrono::microseconds d(1);; d = std::min(2 * d,
+    std::chrono::microseconds(1000)))
+  {
+    if (pred()) return true;
+    else if (auto const now(C::now()); now >= t) return false;
+    else std::this_thread::sleep_for(std::min<typename C::duration>(d,
+      t - now));
+  }
+#endif
+}
+
+}
+
+}
+
+#endif // DQ_WAIT_HPP
@@ -0,0 +1,290 @@
+#ifndef DQ_WINDOW_TOPK_HPP
+# define DQ_WINDOW_TOPK_HPP
+# pragma once
+
+#include <bit> // std::has_single_bit()
+#include <functional> // std::hash
+#include <span>
+
+#include "array.hpp"
+#include "index.hpp"
+
+namespace dq
+{
+
+template <typename Key, std::size_t CAP, std::size_t K,
+  enum Method M = MEMBER, typename H = std::hash<Key>>
+requires((K > 0) && (K <= CAP))
+class window_topk
+{ // exact counts of the last CAP keys, top K readable in O(K)
+public:
+  using key_type = Key;
+  using size_type = std::size_t;
+
+  struct entry { Key key; size_type count; };
+
+//private:
+  array<Key, CAP, M> r_; // recent keys, in arrival order
+
+  entry e_[CAP]; // entries, sorted by descending count
+  size_type s_[CAP]; // index bucket of every entry
+  size_type n_{}; // number of entries
+
+  // entries with count c occupy [b_[c], t_[c]) when present
+  size_type b_[CAP + 1], t_[CAP + 1];
+
+  detail::index<CAP> x_; // key -> entry position
+
+  constexpr auto find_(Key const& k) const noexcept(noexcept(H{}(k)))
+  { // returns the bucket of k or the empty bucket where k belongs
+    return x_.find(H{}(k),
+      [&](auto const p) noexcept(noexcept(e_->key == k))
+      {
+        return e_[p].key == k;
+      }
+    );
+  }
+
+  constexpr void unlink_(size_type const i) noexcept(noexcept(H{}(e_->key)))
+  {
+    x_.erase(
+      i,
+      [&](auto const p) noexcept(noexcept(H{}(e_->key)))
+      {
+        return H{}(e_[p].key);
+      },
+      [&](auto const p, auto const j) noexcept { s_[p] = j; }
+    );
+  }
+
+  constexpr void swap_(size_type const p, size_type const q) noexcept
+  {
+    if (p != q)
+    {
+      std::swap(e_[p], e_[q]); std::swap(s_[p], s_[q]);
+      x_.set(s_[p], p); x_.set(s_[q], q);
+    }
+  }
+
+  constexpr void inc_(Key const& k) noexcept(noexcept(find_(k)))
+  {
+    size_type p;
+
+    if (auto const i(find_(k)); x_.used(i))
+      p = x_.pos(i);
+    else
+    { // new entry joins the (empty) zero block at the tail
+      e_[p = n_++] = {k, {}}; s_[p] = i; x_.set(i, p);
+      b_[0] = p; t_[0] = n_;
+    }
+
+    // swap with the head of its block, then grow the block above
+    auto const c(e_[p].count), q(b_[c]++);
+
+    swap_(p, q); ++e_[q].count;
+
+    if (q && (e_[q - 1].count == c + 1)) t_[c + 1] = q + 1;
+    else b_[c + 1] = q, t_[c + 1] = q + 1;
+  }
+
+  constexpr void dec_(Key const& k) noexcept(noexcept(find_(k)))
+  { // k is always present, it was evicted from r_
+    auto const p(x_.pos(find_(k)));
+
+    // swap with the tail of its block, then grow the block below
+    auto const c(e_[p].count), q(--t_[c]);
+
+    swap_(p, q);
+
+    if (--e_[q].count) // q + 1 == n_ for a zero count
+    {
+      if ((q + 1 == n_) || (e_[q + 1].count != c - 1)) t_[c - 1] = q + 1;
+      b_[c - 1] = q;
+    }
+    else
+    {
+      unlink_(s_[q]); --n_;
+    }
+  }
+
+public:
+  window_topk() = default;
+
+  //
+  constexpr auto& window() const noexcept { return r_; }
+
+  constexpr auto size() const noexcept { return r_.size(); }
+  constexpr size_type distinct() const noexcept { return n_; }
+
+  constexpr bool empty() const noexcept { return r_.empty(); }
+  constexpr bool full() const noexcept { return r_.full(); }
+
+  static constexpr size_type capacity() noexcept { return CAP; }
+
+  //
+  constexpr size_type count(Key const& k) const
+    noexcept(noexcept(find_(k)))
+  {
+    auto const i(find_(k)); return x_.used(i) ? e_[x_.pos(i)].count : 0;
+  }
+
+  constexpr std::span<entry const> topk() const noexcept
+  { // sorted by descending count, ties in no particular order
+    return {e_, std::min(size_type(K), n_)};
+  }
+
+  //
+  constexpr void clear() noexcept
+  {
+    r_.clear(); n_ = {}; x_.clear();
+  }
+
+  constexpr void push(Key const& k) noexcept(noexcept(inc_(k)))
+  {
+    if (r_.full()) dec_(r_.front()), r_.pop_front();
+
+    r_.push_back(k); inc_(k);
+  }
+
+  constexpr void push(auto const& ...k) noexcept(noexcept((push(k), ...)))
+    requires(sizeof...(k) > 1)
+  {
+    (push(k), ...);
+  }
+};
+
+template <typename Key, std::size_t CAP, std::size_t K,
+  std::size_t W = 1024, std::size_t D = 4,
+  enum Method M = MEMBER, typename H = std::hash<Key>>
+requires((K > 0) && (K <= CAP) && std::has_single_bit(W) && (W > 1) &&
+  (D > 0) && (D <= 8))
+class window_cms
+{ // count-min sketch of the last CAP keys, counters are bounded by D * W
+public:
+  using key_type = Key;
+  using size_type = std::size_t;
+  using counter_type = std::conditional_t<(CAP <= UINT32_MAX),
+    std::uint32_t, size_type>;
+
+  struct entry { Key key; size_type count; };
+
+//private:
+  static constexpr std::uint64_t seed_[]{
+    0x9e3779b97f4a7c15u, 0xc2b2ae3d27d4eb4fu,
+    0x165667b19e3779f9u, 0xd6e8feb86659fd93u,
+    0xff51afd7ed558ccdu, 0xc4ceb9fe1a85ec53u,
+    0x94d049bb133111ebu, 0xbf58476d1ce4e5b9u
+  };
+
+  array<Key, CAP, M> r_; // recent keys, in arrival order
+
+  counter_type c_[D][W]{};
+
+  entry t_[K]; // heavy hitter candidates, sorted by descending count
+  size_type n_{};
+
+  constexpr void add_(Key const& k, int const d)
+    noexcept(noexcept(H{}(k)))
+  {
+    auto const h(H{}(k));
+
+    for (size_type i{}; i != D; ++i)
+      c_[i][detail::mix(h, seed_[i], std::countr_zero(W))] += d;
+  }
+
+  constexpr void place_(size_type i) noexcept
+  { // restores descending order after t_[i] changed
+    for (; i && (t_[i - 1].count < t_[i].count); --i)
+      std::swap(t_[i - 1], t_[i]);
+
+    for (; (i + 1 < n_) && (t_[i].count < t_[i + 1].count); ++i)
+      std::swap(t_[i], t_[i + 1]);
+  }
+
+  constexpr auto candidate_(Key const& k)
+    noexcept(noexcept(t_->key == k))
+  {
+    return std::find_if(t_, t_ + n_,
+      [&](auto& e) noexcept(noexcept(e.key == k)) { return e.key == k; }) -
+      t_;
+  }
+
+public:
+  window_cms() = default;
+
+  //
+  constexpr auto& window() const noexcept { return r_; }
+
+  constexpr auto size() const noexcept { return r_.size(); }
+  constexpr bool empty() const noexcept { return r_.empty(); }
+  constexpr bool full() const noexcept { return r_.full(); }
+
+  static constexpr size_type capacity() noexcept { return CAP; }
+
+  //
+  constexpr size_type count(Key const& k) const
+    noexcept(noexcept(H{}(k)))
+  { // never underestimates
+    auto const h(H{}(k));
+    auto r(c_[0][detail::mix(h, seed_[0], std::countr_zero(W))]);
+
+    for (size_type i(1); i != D; ++i)
+      r = std::min(r, c_[i][detail::mix(h, seed_[i], std::countr_zero(W))]);
+
+    return r;
+  }
+
+  constexpr std::span<entry const> topk() const noexcept
+  { // approximate, sorted by descending estimated count
+    return {t_, n_};
+  }
+
+  //
+  constexpr void clear() noexcept
+  {
+    r_.clear(); n_ = {}; std::fill_n(&c_[0][0], D * W, counter_type{});
+  }
+
+  constexpr void push(Key const& k)
+    noexcept(noexcept(add_(k, 1), candidate_(k)))
+  {
+    if (r_.full())
+    { // evict
+      auto const& f(r_.front());
+
+      add_(f, -1);
+
+      if (size_type const i(candidate_(f)); i != n_)
+      {
+        if ((t_[i].count = count(f)))
+          place_(i);
+        else
+          std::move(t_ + i + 1, t_ + n_--, t_ + i);
+      }
+
+      r_.pop_front();
+    }
+
+    r_.push_back(k); add_(k, 1);
+
+    //
+    auto const c(count(k));
+
+    if (size_type const i(candidate_(k)); i != n_)
+      t_[i].count = c, place_(i);
+    else if (n_ != K)
+      t_[n_] = {k, c}, place_(n_++);
+    else if (t_[K - 1].count < c)
+      t_[K - 1] = {k, c}, place_(K - 1);
+  }
+
+  constexpr void push(auto const& ...k) noexcept(noexcept((push(k), ...)))
+    requires(sizeof...(k) > 1)
+  {
+    (push(k), ...);
+  }
+};
+
+}
+
+#endif // DQ_WINDOW_TOPK_HPP
@@ -0,0 +1,192 @@
+#ifndef DQ_WS_DEQUE_HPP
+# define DQ_WS_DEQUE_HPP
+# pragma once
+
+#include <atomic>
+#include <memory> // std::unique_ptr
+#include <optional>
+
+#include "array.hpp"
+
+namespace dq
+{
+
+template <typename T, std::size_t CAP = 1024, enum Method M = MEMBER>
+requires(
+  std::is_trivially_copyable_v<T> &&
+  std::atomic<T>::is_always_lock_free &&
+  std::has_single_bit(CAP)
+)
+class ws_deque
+{ // Chase-Lev work-stealing deque, the owner pushes and pops at the back,
+  // thieves steal from the front; NEW grows, MEMBER is fixed at CAP
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+//private:
+  using index_t = std::int64_t;
+
+  struct buffer
+  { // replaced buffers are kept, a late thief may still read one
+    index_t const mask;
+    buffer* const prev;
+    std::unique_ptr<std::atomic<T>[]> a;
+
+    buffer(index_t const n, buffer* const p):
+      mask(n - 1),
+      prev(p),
+      a(new std::atomic<T>[n])
+    {
+    }
+  };
+
+  alignas(64) std::atomic<index_t> t_{}; // thieves
+  alignas(64) std::atomic<index_t> b_{}; // the owner
+
+  std::conditional_t<MEMBER == M,
+    std::atomic<T>[CAP], std::atomic<buffer*>> a_;
+
+  auto cells_(std::memory_order const o) noexcept
+  {
+    if constexpr(MEMBER == M)
+      return std::pair(+a_, index_t(CAP - 1));
+    else
+    {
+      auto const b(a_.load(o)); return std::pair(b->a.get(), b->mask);
+    }
+  }
+
+  void grow_(index_t const b, index_t const t) requires(NEW == M)
+  {
+    auto const o(a_.load(std::memory_order_relaxed));
+    auto const n(new buffer(2 * (o->mask + 1), o));
+
+    for (auto i(t); i != b; ++i)
+      n->a[i & n->mask].store(o->a[i & o->mask].load(
+        std::memory_order_relaxed), std::memory_order_relaxed);
+
+    a_.store(n, std::memory_order_release);
+  }
+
+public:
+  ws_deque() requires(MEMBER == M) = default;
+  ws_deque() requires(NEW == M): a_(new buffer(CAP, {})) { }
+
+  ws_deque(ws_deque const&) = delete;
+  ws_deque& operator=(ws_deque const&) = delete;
+
+  ~ws_deque() requires(NEW != M) = default;
+
+  ~ws_deque() requires(NEW == M)
+  {
+    for (auto b(a_.load(std::memory_order_relaxed)); b;)
+    {
+      auto const p(b->prev); delete b; b = p;
+    }
+  }
+
+  //
+  size_type capacity() const noexcept
+  {
+    if constexpr(MEMBER == M)
+      return CAP;
+    else
+      return a_.load(std::memory_order_relaxed)->mask + 1;
+  }
+
+  size_type size() const noexcept
+  { // a snapshot, exact only for the owner when nobody steals
+    auto const b(b_.load(std::memory_order_relaxed));
+    auto const t(t_.load(std::memory_order_relaxed));
+
+    return b > t ? b - t : 0;
+  }
+
+  bool empty() const noexcept { return !size(); }
+
+  // the owner
+  bool push(T const v) noexcept(MEMBER == M)
+  { // false only if a MEMBER deque is full
+    auto const b(b_.load(std::memory_order_relaxed));
+    auto const t(t_.load(std::memory_order_acquire));
+    auto c(cells_(std::memory_order_relaxed));
+
+    if (b - t > c.second)
+    {
+      if constexpr(MEMBER == M)
+        return false;
+      else
+        grow_(b, t), c = cells_(std::memory_order_relaxed);
+    }
+
+    c.first[b & c.second].store(v, std::memory_order_relaxed);
+    b_.store(b + 1, std::memory_order_release); // publishes v to thieves
+
+    return true;
+  }
+
+  std::optional<T> pop() noexcept
+  { // LIFO
+    auto const b(b_.load(std::memory_order_relaxed) - 1);
+    auto const c(cells_(std::memory_order_relaxed));
+
+    b_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (auto t(t_.load(std::memory_order_relaxed)); t <= b)
+    {
+      auto const v(c.first[b & c.second].load(std::memory_order_relaxed));
+
+      if (t != b) return v;
+
+      // the last element, race the thieves for it
+      auto const won(t_.compare_exchange_strong(t, t + 1,
+        std::memory_order_seq_cst, std::memory_order_relaxed));
+
+      b_.store(b + 1, std::memory_order_relaxed);
+
+      return won ? std::optional<T>(v) : std::nullopt;
+    }
+
+    b_.store(b + 1, std::memory_order_relaxed);
+
+    return {};
+  }
+
+  // any thread
+  std::optional<T> steal() noexcept
+  { // FIFO, empty if there is nothing to steal or another thief won
+    auto t(t_.load(std::memory_order_acquire));
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (t < b_.load(std::memory_order_acquire))
+    {
+      auto const c(cells_(std::memory_order_acquire));
+      auto const v(c.first[t & c.second].load(std::memory_order_relaxed));
+
+      if (t_.compare_exchange_strong(t, t + 1,
+        std::memory_order_seq_cst, std::memory_order_relaxed)) return v;
+    }
+
+    return {};
+  }
+
+  size_type steal_half(auto&& f, size_type const max = -1)
+    noexcept(noexcept(f(std::declval<T>())))
+  { // up to half the elements (at least one) to f, oldest first
+    size_type r{};
+
+    for (auto n(std::min(max, (size() + 1) / 2)); n; --n, ++r)
+      if (auto const v(steal()); v)
+        f(*v);
+      else
+        break;
+
+    return r;
+  }
+};
+
+}
+
+#endif // DQ_WS_DEQUE_HPP